@@ -0,0 +1,76 @@
+#include "bench_util.h"
+#include "collision.h"
+#include "list.h"
+#include "polygon.h"
+#include "vector.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times find_collision() and find_polygon_collision() on regular polygons
+// with more and more vertices, for pairs that overlap (so every axis is
+// checked) and pairs that don't.
+// Build with 'make NO_ASAN=true bench' for meaningful timings.
+
+const size_t VERTEX_COUNTS[] = {4, 16, 64, 256};
+const double SHAPE_RADIUS = 10;
+
+list_t *make_regular_polygon(size_t vertices, vector_t center) {
+  list_t *shape = list_init(vertices, free);
+  for (size_t i = 0; i < vertices; i++) {
+    double angle = 2 * M_PI * i / vertices;
+    vector_t *point = malloc(sizeof(vector_t));
+    *point = (vector_t){center.x + SHAPE_RADIUS * cos(angle),
+                        center.y + SHAPE_RADIUS * sin(angle)};
+    list_add(shape, point);
+  }
+  return shape;
+}
+
+typedef struct {
+  list_t *shape1, *shape2;
+  polygon_t *polygon1, *polygon2;
+  // keeps the results alive, so the calls aren't optimized out
+  size_t collisions;
+} collision_aux_t;
+
+void time_find_collision(void *aux, size_t iterations) {
+  collision_aux_t *pair = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    pair->collisions += find_collision(pair->shape1, pair->shape2);
+  }
+}
+
+void time_find_polygon_collision(void *aux, size_t iterations) {
+  collision_aux_t *pair = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    pair->collisions += find_polygon_collision(pair->polygon1, pair->polygon2);
+  }
+}
+
+int main() {
+  for (size_t i = 0; i < sizeof(VERTEX_COUNTS) / sizeof(*VERTEX_COUNTS); i++) {
+    size_t vertices = VERTEX_COUNTS[i];
+    for (int overlapping = 1; overlapping >= 0; overlapping--) {
+      // overlapping pairs are offset by less than a radius, the others by
+      // more than a diameter
+      vector_t offset = {overlapping ? SHAPE_RADIUS / 2 : 3 * SHAPE_RADIUS, SHAPE_RADIUS / 3};
+      collision_aux_t pair = {
+          .shape1 = make_regular_polygon(vertices, VEC_ZERO),
+          .shape2 = make_regular_polygon(vertices, offset),
+          .collisions = 0};
+      pair.polygon1 = polygon_from_list(pair.shape1);
+      pair.polygon2 = polygon_from_list(pair.shape2);
+      char name[64];
+      snprintf(name, sizeof(name), "%zu vertices, %s", vertices,
+               overlapping ? "overlapping" : "apart");
+      bench_run("find_collision", name, time_find_collision, &pair);
+      bench_run("find_polygon_collision", name, time_find_polygon_collision,
+                &pair);
+      list_free(pair.shape1);
+      list_free(pair.shape2);
+      polygon_free(pair.polygon1);
+      polygon_free(pair.polygon2);
+    }
+  }
+}
@@ -0,0 +1,160 @@
+#include "bench_util.h"
+#include "fmm.h"
+#include "quadtree.h"
+#include "vector.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Compares the fast multipole method with Barnes-Hut on a large scene.
+// Each method is timed over whole solves, and its error relative to the
+// exact field is reported alongside.
+// Build with 'make NO_ASAN=true bench' for meaningful timings.
+
+const size_t NUM_POINTS = 100000;
+const double WORLD_SIZE = 100000;
+const double MIN_PULL_DISTANCE = 5.0;
+// the exact field is only computed at this many points, since it's O(n^2)
+#define NUM_SAMPLES 200
+// a solve over every point takes up to seconds, so each method is only
+// timed over this many (and as many warmup solves), not bench_run()'s 25
+const size_t SOLVE_SAMPLES = 3;
+
+typedef struct {
+  vector_t *positions;
+  double *masses;
+  // the point the exact field is computed at next
+  size_t next_point;
+  // the fields at the first NUM_SAMPLES points, from the last solve
+  vector_t fields[NUM_SAMPLES];
+  quadtree_t *tree;
+  double theta;
+  fmm_t *fmm;
+} field_aux_t;
+
+vector_t exact_field(vector_t *positions, double *masses, size_t index) {
+  vector_t field = VEC_ZERO;
+  for (size_t j = 0; j < NUM_POINTS; j++) {
+    double dx = positions[j].x - positions[index].x;
+    double dy = positions[j].y - positions[index].y;
+    double distance = sqrt(dx * dx + dy * dy);
+    if (distance == 0 || distance < MIN_PULL_DISTANCE) {
+      continue;
+    }
+    double strength = masses[j] / (distance * distance * distance);
+    field.x += strength * dx;
+    field.y += strength * dy;
+  }
+  return field;
+}
+
+// each iteration computes the exact field at one of the sampled points
+void time_direct(void *aux, size_t iterations) {
+  field_aux_t *data = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    size_t point = data->next_point;
+    data->fields[point] = exact_field(data->positions, data->masses, point);
+    data->next_point = (point + 1) % NUM_SAMPLES;
+  }
+}
+
+// each iteration builds the tree and finds the field at every point
+void time_barnes_hut(void *aux, size_t iterations) {
+  field_aux_t *data = aux;
+  for (size_t r = 0; r < iterations; r++) {
+    quadtree_clear(data->tree);
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+      quadtree_add_point(data->tree, data->positions[i], data->masses[i]);
+    }
+    quadtree_build(data->tree);
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+      vector_t field = quadtree_field(data->tree, data->positions[i],
+                                      data->theta, MIN_PULL_DISTANCE);
+      if (i < NUM_SAMPLES) {
+        data->fields[i] = field;
+      }
+    }
+  }
+}
+
+// each iteration solves for the field at every point
+void time_fmm(void *aux, size_t iterations) {
+  field_aux_t *data = aux;
+  for (size_t r = 0; r < iterations; r++) {
+    fmm_clear(data->fmm);
+    for (size_t i = 0; i < NUM_POINTS; i++) {
+      fmm_add_point(data->fmm, data->positions[i], data->masses[i]);
+    }
+    fmm_solve(data->fmm, MIN_PULL_DISTANCE);
+  }
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    data->fields[i] = fmm_get_field(data->fmm, i);
+  }
+}
+
+double norm(vector_t v) { return sqrt(vec_dot(v, v)); }
+
+// reports the error of the last solve relative to the exact field
+void report_error(const char *name, field_aux_t *data, vector_t *exact) {
+  double error = 0;
+  double total = 0;
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    error += norm(vec_subtract(data->fields[i], exact[i]));
+    total += norm(exact[i]);
+  }
+  bench_report_value("gravity_field", name, "relative_error", error / total);
+}
+
+int main() {
+  srand(1);
+  field_aux_t data = {.next_point = 0};
+  data.positions = malloc(sizeof(vector_t) * NUM_POINTS);
+  data.masses = malloc(sizeof(double) * NUM_POINTS);
+  for (size_t i = 0; i < NUM_POINTS; i++) {
+    // a dense disk inside a sparse square, so the trees are uneven
+    if (i % 4 == 0) {
+      double angle = (double)rand() / RAND_MAX * 2 * M_PI;
+      double radius = sqrt((double)rand() / RAND_MAX) * WORLD_SIZE / 20;
+      data.positions[i] = (vector_t){WORLD_SIZE / 2 + radius * cos(angle),
+                                     WORLD_SIZE / 2 + radius * sin(angle)};
+    } else {
+      data.positions[i] = (vector_t){(double)rand() / RAND_MAX * WORLD_SIZE,
+                                     (double)rand() / RAND_MAX * WORLD_SIZE};
+    }
+    data.masses[i] = 1 + rand() % 100;
+  }
+
+  vector_t exact[NUM_SAMPLES];
+  for (size_t i = 0; i < NUM_SAMPLES; i++) {
+    exact[i] = exact_field(data.positions, data.masses, i);
+  }
+  char name[64];
+  // the direct sum takes NUM_POINTS times this for every point
+  snprintf(name, sizeof(name), "direct, one of %zu points", NUM_POINTS);
+  bench_run("gravity_field", name, time_direct, &data);
+
+  double thetas[] = {0.3, 0.5, 0.8};
+  for (size_t t = 0; t < sizeof(thetas) / sizeof(*thetas); t++) {
+    data.tree = quadtree_init();
+    data.theta = thetas[t];
+    snprintf(name, sizeof(name), "barnes-hut %.1f, %zu points", thetas[t],
+             NUM_POINTS);
+    bench_run_samples("gravity_field", name, time_barnes_hut, &data,
+                      SOLVE_SAMPLES);
+    report_error(name, &data, exact);
+    quadtree_free(data.tree);
+  }
+
+  size_t orders[] = {2, 4, 6, 8, 12};
+  for (size_t o = 0; o < sizeof(orders) / sizeof(*orders); o++) {
+    data.fmm = fmm_init(orders[o]);
+    snprintf(name, sizeof(name), "fmm order %zu, %zu points", orders[o],
+             NUM_POINTS);
+    bench_run_samples("gravity_field", name, time_fmm, &data, SOLVE_SAMPLES);
+    report_error(name, &data, exact);
+    fmm_free(data.fmm);
+  }
+
+  free(data.positions);
+  free(data.masses);
+}
@@ -0,0 +1,112 @@
+#include "bench_util.h"
+#include "body.h"
+#include "kinematics.h"
+#include "list.h"
+#include "vector.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Compares moving bodies one at a time with body_tick() against moving a
+// kinematics store with the scalar and the SIMD loops. Each iteration is one
+// step of every body; a checksum of the positions after a fixed number of
+// steps is reported alongside, so the methods can be checked against each
+// other.
+// Build with 'make NO_ASAN=true bench' for meaningful timings.
+
+const size_t NUM_BODIES = 10000;
+// the number of steps the checksum is taken after
+const size_t NUM_STEPS = 1000;
+const double DT = 1e-3;
+
+list_t *make_triangle() {
+  list_t *shape = list_init(3, free);
+  vector_t points[] = {{0, 0}, {1, 0}, {0, 1}};
+  for (size_t i = 0; i < 3; i++) {
+    vector_t *point = malloc(sizeof(vector_t));
+    *point = points[i];
+    list_add(shape, point);
+  }
+  return shape;
+}
+
+// puts every body back where it started
+void reset_bodies(body_t **bodies) {
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_set_centroid(bodies[i], (vector_t){i % 100, i / 100});
+    body_set_velocity(bodies[i], (vector_t){sin(i), cos(i)});
+    body_set_rotation(bodies[i], 0);
+  }
+}
+
+// sums the positions, so the three methods can be checked against each other
+double checksum(body_t **bodies) {
+  double sum = 0;
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    vector_t centroid = body_get_centroid(bodies[i]);
+    sum += centroid.x + centroid.y;
+  }
+  return sum;
+}
+
+// each iteration moves every body one step
+void time_body_tick(void *aux, size_t iterations) {
+  body_t **bodies = aux;
+  for (size_t step = 0; step < iterations; step++) {
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      body_tick(bodies[i], DT);
+    }
+  }
+}
+
+typedef struct {
+  kinematics_t *kinematics;
+  void (*integrate)(kinematics_t *kinematics, double dt);
+} store_aux_t;
+
+void time_store(void *aux, size_t iterations) {
+  store_aux_t *store = aux;
+  for (size_t step = 0; step < iterations; step++) {
+    store->integrate(store->kinematics, DT);
+  }
+}
+
+// times a method, then checks it by reporting the checksum after
+// NUM_STEPS steps from the starting positions
+void bench_method(const char *name, bench_func_t func, void *aux,
+                  body_t **bodies) {
+  reset_bodies(bodies);
+  bench_run("integrate", name, func, aux);
+  reset_bodies(bodies);
+  func(aux, NUM_STEPS);
+  bench_report_value("integrate", name, "checksum", checksum(bodies));
+}
+
+int main() {
+  body_t **bodies = malloc(sizeof(body_t *) * NUM_BODIES);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    bodies[i] = body_init(make_triangle(), 1 + i % 7, (rgb_color_t){0, 0, 0});
+    body_set_rotational_velocity(bodies[i], 0.01);
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "body_tick, %zu bodies", NUM_BODIES);
+  bench_method(name, time_body_tick, bodies, bodies);
+
+  kinematics_t *kinematics = kinematics_init(NUM_BODIES);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_attach_kinematics(bodies[i], kinematics);
+  }
+  store_aux_t stores[] = {{kinematics, kinematics_integrate_scalar},
+                          {kinematics, kinematics_integrate}};
+  snprintf(name, sizeof(name), "store, scalar, %zu bodies", NUM_BODIES);
+  bench_method(name, time_store, &stores[0], bodies);
+  snprintf(name, sizeof(name), "store, %zu SIMD lanes, %zu bodies",
+           kinematics_lanes(), NUM_BODIES);
+  bench_method(name, time_store, &stores[1], bodies);
+
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    body_free(bodies[i]);
+  }
+  kinematics_free(kinematics);
+  free(bodies);
+}
@@ -0,0 +1,129 @@
+#include "bench_util.h"
+#include "body.h"
+#include "list.h"
+#include "polygon.h"
+#include "vector.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times the small operations every tick is made of: moving a body,
+// computing a polygon's centroid, and adding to and removing from lists.
+// Build with 'make NO_ASAN=true bench' for meaningful timings.
+
+const size_t CENTROID_VERTEX_COUNTS[] = {4, 64};
+// the number of elements each list iteration adds and removes
+const size_t LIST_ELEMENTS = 1000;
+
+list_t *make_circle(size_t vertices) {
+  list_t *shape = list_init(vertices, free);
+  for (size_t i = 0; i < vertices; i++) {
+    double angle = 2 * M_PI * i / vertices;
+    vector_t *point = malloc(sizeof(vector_t));
+    *point = (vector_t){cos(angle) + 3, sin(angle) - 2};
+    list_add(shape, point);
+  }
+  return shape;
+}
+
+void time_body_tick(void *aux, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    body_tick(aux, 1e-3);
+  }
+}
+
+typedef struct {
+  list_t *shape;
+  polygon_t *polygon;
+  // keeps the results alive, so the calls aren't optimized out
+  double sum;
+} centroid_aux_t;
+
+void time_polygon_centroid(void *aux, size_t iterations) {
+  centroid_aux_t *centroid = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    centroid->sum += polygon_centroid(centroid->shape).x;
+  }
+}
+
+void time_polygon_compute_centroid(void *aux, size_t iterations) {
+  centroid_aux_t *centroid = aux;
+  for (size_t i = 0; i < iterations; i++) {
+    centroid->sum += polygon_compute_centroid(centroid->polygon).x;
+  }
+}
+
+// each iteration adds LIST_ELEMENTS pointers to an empty list,
+// then removes them all from one end
+void time_list_remove_back(void *list, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < LIST_ELEMENTS; j++) {
+      list_add(list, list);
+    }
+    for (size_t j = LIST_ELEMENTS; j > 0; j--) {
+      list_remove(list, j - 1);
+    }
+  }
+}
+
+void time_list_remove_front(void *list, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < LIST_ELEMENTS; j++) {
+      list_add(list, list);
+    }
+    for (size_t j = 0; j < LIST_ELEMENTS; j++) {
+      list_remove(list, 0);
+    }
+  }
+}
+
+void time_list_swap_remove(void *list, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    for (size_t j = 0; j < LIST_ELEMENTS; j++) {
+      list_add(list, list);
+    }
+    for (size_t j = 0; j < LIST_ELEMENTS; j++) {
+      list_swap_remove(list, 0);
+    }
+  }
+}
+
+int main() {
+  body_t *body = body_init(make_circle(3), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){1, 2});
+  body_add_force(body, (vector_t){0, -1});
+  bench_run("body_tick", "moving", time_body_tick, body);
+  body_set_rotational_velocity(body, 1e-3);
+  bench_run("body_tick", "moving and spinning", time_body_tick, body);
+  body_free(body);
+
+  for (size_t i = 0;
+       i < sizeof(CENTROID_VERTEX_COUNTS) / sizeof(*CENTROID_VERTEX_COUNTS);
+       i++) {
+    centroid_aux_t centroid = {.shape = make_circle(CENTROID_VERTEX_COUNTS[i]),
+                               .sum = 0};
+    centroid.polygon = polygon_from_list(centroid.shape);
+    char name[64];
+    snprintf(name, sizeof(name), "%zu vertices", CENTROID_VERTEX_COUNTS[i]);
+    bench_run("polygon_centroid", name, time_polygon_centroid, &centroid);
+    bench_run("polygon_compute_centroid", name, time_polygon_compute_centroid,
+              &centroid);
+    list_free(centroid.shape);
+    polygon_free(centroid.polygon);
+  }
+
+  // the list doesn't own its elements, and keeps its capacity between
+  // iterations, as a scene's lists do
+  list_t *list = list_init(LIST_ELEMENTS, NULL);
+  char name[64];
+  snprintf(name, sizeof(name), "%zu adds, removing from the back",
+           LIST_ELEMENTS);
+  bench_run("list_add/list_remove", name, time_list_remove_back, list);
+  snprintf(name, sizeof(name), "%zu adds, removing from the front",
+           LIST_ELEMENTS);
+  bench_run("list_add/list_remove", name, time_list_remove_front, list);
+  snprintf(name, sizeof(name), "%zu adds, swap removing from the front",
+           LIST_ELEMENTS);
+  bench_run("list_add/list_swap_remove", name, time_list_swap_remove, list);
+  list_free(list);
+}
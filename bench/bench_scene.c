@@ -0,0 +1,102 @@
+#include "bench_util.h"
+#include "body.h"
+#include "forces.h"
+#include "list.h"
+#include "scene.h"
+#include "vector.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Times scene_tick() on scenes of different sizes with different mixes of
+// forces and collision detection.
+// Build with 'make NO_ASAN=true bench' for meaningful timings.
+
+const size_t BODY_COUNTS[] = {100, 1000};
+// small, so the scenes barely change however many ticks are timed
+const double DT = 1e-4;
+// the bodies are 2 wide, so neighbours in a row overlap, but rows don't
+const double COLUMN_SPACING = 1.8;
+const double ROW_SPACING = 4;
+
+typedef enum {
+  MIX_GRAVITY,
+  MIX_SPRINGS,
+  MIX_COLLISIONS,
+  MIX_ALL,
+  NUM_MIXES
+} mix_t;
+
+const char *MIX_NAMES[] = {"gravity", "springs and drag", "collisions",
+                           "gravity, springs, drag and collisions"};
+
+list_t *make_square() {
+  list_t *shape = list_init(4, free);
+  vector_t points[] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *point = malloc(sizeof(vector_t));
+    *point = points[i];
+    list_add(shape, point);
+  }
+  return shape;
+}
+
+// counts collisions without resolving them, so the scene doesn't change
+void count_collision(body_t *body1, body_t *body2, void *aux) {
+  (*(size_t *)aux)++;
+}
+
+// lays out the bodies on a square grid
+scene_t *make_scene(size_t count, mix_t mix) {
+  scene_t *scene = scene_init();
+  size_t row = (size_t)ceil(sqrt(count));
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = body_init(make_square(), 1 + i % 3, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body,
+                      (vector_t){i % row * COLUMN_SPACING, i / row * ROW_SPACING});
+    body_set_velocity(body, (vector_t){sin(i), cos(i)});
+    scene_add_body(scene, body);
+  }
+  if (mix == MIX_GRAVITY || mix == MIX_ALL) {
+    list_t *bodies = list_init(count, NULL);
+    for (size_t i = 0; i < count; i++) {
+      list_add(bodies, scene_get_body(scene, i));
+    }
+    create_all_pairs_gravity(scene, 1, bodies);
+  }
+  if (mix == MIX_SPRINGS || mix == MIX_ALL) {
+    for (size_t i = 0; i < count; i++) {
+      if (i > 0) {
+        create_spring(scene, 1, scene_get_body(scene, i - 1),
+                      scene_get_body(scene, i));
+      }
+      create_drag(scene, 0.1, scene_get_body(scene, i));
+    }
+  }
+  if (mix == MIX_COLLISIONS || mix == MIX_ALL) {
+    size_t *collisions = malloc(sizeof(size_t));
+    *collisions = 0;
+    scene_set_collision_handler(scene, count_collision, collisions, free);
+    scene_set_aabb_tree(scene, 0.5);
+  }
+  return scene;
+}
+
+void time_scene_tick(void *scene, size_t iterations) {
+  for (size_t i = 0; i < iterations; i++) {
+    scene_tick(scene, DT);
+  }
+}
+
+int main() {
+  for (size_t i = 0; i < sizeof(BODY_COUNTS) / sizeof(*BODY_COUNTS); i++) {
+    for (mix_t mix = 0; mix < NUM_MIXES; mix++) {
+      scene_t *scene = make_scene(BODY_COUNTS[i], mix);
+      char name[128];
+      snprintf(name, sizeof(name), "%s, %zu bodies", MIX_NAMES[mix],
+               BODY_COUNTS[i]);
+      bench_run("scene_tick", name, time_scene_tick, scene);
+      scene_free(scene);
+    }
+  }
+}
@@ -128,16 +128,20 @@ state_t *emscripten_init() {
 void emscripten_main(state_t *state) {
 
   sdl_clear();
-  double dt = time_since_last_tick();
-  scene_tick(state->balls, dt);
+  // physics runs in fixed steps, however long the frame took
+  scene_advance(state->balls, time_since_last_tick());
+  double alpha = scene_interpolation_alpha(state->balls);
 
   // draw the polygons
   list_t *bodies = scene_get_all_bodies(state->balls);
+  // the shapes are copied into the frame arena, so they don't need to be freed
+  arena_t *frame_arena = scene_frame_arena(state->balls);
   for (size_t i = 0; i < list_size(bodies); i++) {
     void *body = list_get(bodies, i);
     rgb_color_t color = body_get_color(body);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, color);
+    polygon_t *shape =
+        body_get_interpolated_shape_in_arena(body, alpha, frame_arena);
+    sdl_draw_shape(shape, color);
   }
   sdl_show();
 }
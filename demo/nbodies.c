@@ -69,6 +69,8 @@ state_t *emscripten_init() {
 
   state_t *state = malloc(sizeof(state_t));
   state->stars = scene_init();
+  // integrate every star in one loop over dense arrays
+  scene_set_dense_storage(state->stars);
   for (size_t i = 0; i < NUM_STARS; i++) {
     // create random color
     rgb_color_t *color = get_random_color();
@@ -93,17 +95,12 @@ state_t *emscripten_init() {
     scene_add_body(state->stars, star);
   }
 
-  // for every unique pair of bodies, initialize a gravitational force between
-  // them
-  list_t *bodies = scene_get_all_bodies(state->stars);
-  for (size_t i = 0; i < list_size(bodies) - 1; i++) {
-    body_t *star1 = list_get(bodies, i);
-    for (size_t j = i + 1; j < list_size(bodies); j++) {
-      body_t *star2 = list_get(bodies, j);
-      create_newtonian_gravity(state->stars, GRAVITATIONAL_CONSTANT, star1,
-                               star2);
-    }
+  // one force creator applies gravity between every pair of stars
+  list_t *stars = list_init(NUM_STARS, NULL);
+  for (size_t i = 0; i < scene_bodies(state->stars); i++) {
+    list_add(stars, scene_get_body(state->stars, i));
   }
+  create_all_pairs_gravity(state->stars, GRAVITATIONAL_CONSTANT, stars);
 
   return state;
 }
@@ -111,16 +108,20 @@ state_t *emscripten_init() {
 void emscripten_main(state_t *state) {
 
   sdl_clear();
-  double dt = time_since_last_tick();
-  scene_tick(state->stars, dt);
+  // physics runs in fixed steps, however long the frame took
+  scene_advance(state->stars, time_since_last_tick());
+  double alpha = scene_interpolation_alpha(state->stars);
 
   // draw the polygons
   list_t *bodies = scene_get_all_bodies(state->stars);
+  // the shapes are copied into the frame arena, so they don't need to be freed
+  arena_t *frame_arena = scene_frame_arena(state->stars);
   for (size_t i = 0; i < list_size(bodies); i++) {
     void *body = list_get(bodies, i);
     rgb_color_t color = body_get_color(body);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, color);
+    polygon_t *shape =
+        body_get_interpolated_shape_in_arena(body, alpha, frame_arena);
+    sdl_draw_shape(shape, color);
   }
   sdl_show();
 }
@@ -161,7 +161,7 @@ void emscripten_main(state_t *state) {
       (rgb_color_t){.r = not_normalized_color.r / 255,
                     .g = not_normalized_color.g / 255,
                     .b = not_normalized_color.b / 255};
-  sdl_draw_polygon(body_get_shape(state->pacman), normalized_color);
+  sdl_draw_shape(body_peek_shape(state->pacman), normalized_color);
 
   // spawn a new pellet every x seconds
   if (state->time_elapsed >= PELLET_SPAWN_INTERVAL) {
@@ -183,7 +183,7 @@ void emscripten_main(state_t *state) {
           *((vector_t *)list_get(get_pellet_polygon(curr_pellet), j));
       double distance = vec_l2norm(point, body_get_centroid(state->pacman));
       if (distance < PACMAN_RADIUS) {
-        list_remove(state->pellets, i);
+        list_swap_remove(state->pellets, i);
         break;
       }
     }
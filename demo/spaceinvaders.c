@@ -48,8 +48,16 @@ const double PLAYER_BOTTOM_MARGIN = 30;
 const double LASER_WIDTH = 1;
 const double LASER_HEIGHT = 7;
 
+// how far bodies can move before they are reinserted into the AABB tree
+// used for collision detection
+const double COLLISION_MARGIN = 10;
+
 typedef struct state {
   scene_t *scene;
+  // the enemies still alive, refilled every frame
+  list_t *enemies;
+  // the player is kept by handle rather than looked up every time
+  body_handle_t player;
   size_t enemy_horz_margin;
   double time_elapsed;
 } state_t;
@@ -98,8 +106,9 @@ body_t *create_player_body() {
   return ret;
 }
 
-// create laser body
-body_t *create_laser_body(bool is_enemy, vector_t spawn_loc) {
+// create laser body and add it to the scene. lasers are created and
+// destroyed constantly, so they come from the scene's body pool
+body_t *create_laser_body(scene_t *scene, bool is_enemy, vector_t spawn_loc) {
   // laser is just a rectangle
   list_t *laser_points = list_init(4, NULL);
   vector_t *point_1 = malloc(sizeof(vector_t));
@@ -121,16 +130,16 @@ body_t *create_laser_body(bool is_enemy, vector_t spawn_loc) {
   if (is_enemy) {
     size_t *body_info = malloc(sizeof(size_t));
     *body_info = 2;
-    body_t *ret = body_init_with_info(laser_points, 1, ENEMY_LASER_COLOR,
-                                      body_info, free);
+    body_t *ret = scene_body_init(scene, laser_points, 1, ENEMY_LASER_COLOR,
+                                  body_info, free);
     body_set_velocity(ret, INITIAL_ENEMY_LASER_VELOCITY);
     body_set_centroid(ret, spawn_loc);
     return ret;
   } else {
     size_t *body_info = malloc(sizeof(size_t));
     *body_info = 3;
-    body_t *ret = body_init_with_info(laser_points, 1, PLAYER_LASER_COLOR,
-                                      body_info, free);
+    body_t *ret = scene_body_init(scene, laser_points, 1, PLAYER_LASER_COLOR,
+                                  body_info, free);
     body_set_velocity(ret, INITIAL_PLAYER_LASER_VELOCITY);
     body_set_centroid(ret, spawn_loc);
     return ret;
@@ -138,12 +147,7 @@ body_t *create_laser_body(bool is_enemy, vector_t spawn_loc) {
 }
 
 body_t *get_player_body(state_t *state) {
-  for (size_t i = 0; i < list_size(scene_get_all_bodies(state->scene)); i++) {
-    if (*(size_t *)body_get_info(
-            list_get(scene_get_all_bodies(state->scene), i)) == 1) {
-      return (body_t *)list_get(scene_get_all_bodies(state->scene), i);
-    }
-  }
+  return scene_resolve(state->scene, state->player);
 }
 
 void update_player(state_t *state, char key, double held_time) {
@@ -158,15 +162,9 @@ void update_player(state_t *state, char key, double held_time) {
     body_set_velocity(get_player_body(state), new_velocity);
     break;
   case UP_ARROW:
-    // spawn player bullet after finding the index of player body
-    for (size_t i = 0; i < list_size(scene_get_all_bodies(state->scene)); i++) {
-      if (*(size_t *)body_get_info(
-              list_get(scene_get_all_bodies(state->scene), i)) == 1) {
-        body_t *laser =
-            create_laser_body(false, body_get_centroid(get_player_body(state)));
-        scene_add_body(state->scene, laser);
-      }
-    }
+    // spawn player bullet at the player
+    create_laser_body(state->scene, false,
+                      body_get_centroid(get_player_body(state)));
     break;
   }
 }
@@ -177,6 +175,18 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
   }
 }
 
+// called by the scene on every pair of colliding bodies.
+// player bullets destroy enemies; enemy bullets hitting the player are
+// handled by the game over check at the start of each frame
+void handle_collision(body_t *body1, body_t *body2, void *aux) {
+  size_t type1 = *(size_t *)body_get_info(body1);
+  size_t type2 = *(size_t *)body_get_info(body2);
+  if ((type1 == 0 && type2 == 3) || (type1 == 3 && type2 == 0)) {
+    body_remove(body1);
+    body_remove(body2);
+  }
+}
+
 state_t *emscripten_init() {
   srand(time(NULL));
   sdl_on_key(on_key);
@@ -187,6 +197,11 @@ state_t *emscripten_init() {
   state_t *state = malloc(sizeof(state_t));
   state->scene = scene_init();
   state->time_elapsed = 0;
+  state->enemies = list_init(NUM_ENEMIES_PER_ROW * NUM_ENEMIES_ROWS, NULL);
+  // use a broad phase so collision checks stay cheap with many lasers.
+  // a tree suits the mix of tiny lasers and wide enemies better than a grid
+  scene_set_aabb_tree(state->scene, COLLISION_MARGIN);
+  scene_set_collision_handler(state->scene, handle_collision, NULL, NULL);
 
   double body_width = ENEMY_RADIUS * 2;
   list_t *enemies =
@@ -237,6 +252,7 @@ state_t *emscripten_init() {
 
   // add player to the scene
   scene_add_body(state->scene, player);
+  state->player = scene_get_handle(state->scene, player);
 
   return state;
 }
@@ -245,8 +261,9 @@ void emscripten_main(state_t *state) {
   sdl_clear();
   double dt = time_since_last_tick();
   state->time_elapsed += dt;
-  list_t *enemies =
-      list_init(NUM_ENEMIES_PER_ROW * NUM_ENEMIES_ROWS, body_free);
+  // the list only borrows the scene's bodies, so clearing it frees nothing
+  list_t *enemies = state->enemies;
+  list_clear(enemies);
 
   // get list of enemies
   for (size_t i = 0; i < scene_bodies(state->scene); i++) {
@@ -257,19 +274,16 @@ void emscripten_main(state_t *state) {
   }
 
   // get player body
-  body_t *player_body;
-  for (size_t i = 0; i < scene_bodies(state->scene); i++) {
-    body_t *curr_body = scene_get_body(state->scene, i);
-    if (*(size_t *)(body_get_info(curr_body)) == 1) {
-      player_body = curr_body;
-    }
-  }
+  body_t *player_body = get_player_body(state);
 
-  // draw all bodies
+  // draw all bodies. the shapes are copied into the frame arena,
+  // which scene_tick() releases
   list_t *all_bodies = scene_get_all_bodies(state->scene);
+  arena_t *frame_arena = scene_frame_arena(state->scene);
   for (size_t i = 0; i < list_size(all_bodies); i++) {
-    sdl_draw_polygon(body_get_shape(list_get(all_bodies, i)),
-                     body_get_color(list_get(all_bodies, i)));
+    body_t *body = list_get(all_bodies, i);
+    sdl_draw_shape(body_get_shape_in_arena(body, frame_arena),
+                   body_get_color(body));
   }
 
   // GAME OVER SENARIOS--------
@@ -279,10 +293,7 @@ void emscripten_main(state_t *state) {
   while (idx < list_size(all_bodies)) {
     body_t *curr_body = (body_t *)list_get(all_bodies, idx);
     if (*(size_t *)body_get_info(curr_body) == 2) {
-      body_t *temp_bullet = (body_t *)list_get(all_bodies, idx);
-      aux_t *aux = aux_init(temp_bullet, player_body, 0);
-      collision(aux);
-      if (body_is_removed(curr_body) == true) {
+      if (find_body_collision(curr_body, player_body)) {
         exit(0);
       }
     }
@@ -299,9 +310,9 @@ void emscripten_main(state_t *state) {
     // iterate through all the vertices of the shape and check if the y
     // component is below 0
     body_t *curr_enemy = list_get(enemies, i);
-    list_t *curr_shape = body_get_shape(curr_enemy);
-    for (size_t j = 0; j < list_size(curr_shape); j++) {
-      if ((*(vector_t *)(list_get(curr_shape, j))).y < 0) {
+    polygon_t *curr_shape = body_get_shape_in_arena(curr_enemy, frame_arena);
+    for (size_t j = 0; j < curr_shape->size; j++) {
+      if (curr_shape->y[j] < 0) {
         exit(0);
       }
     }
@@ -311,9 +322,9 @@ void emscripten_main(state_t *state) {
   // enemies shoot
   if (state->time_elapsed > ENEMY_SHOOT_INTERVAL) {
     size_t enemy_to_shoot = rand() % list_size(enemies);
-    scene_add_body(state->scene,
-                   create_laser_body(true, body_get_centroid(list_get(
-                                               enemies, enemy_to_shoot))));
+    create_laser_body(
+        state->scene, true,
+        body_get_centroid(list_get(enemies, enemy_to_shoot)));
     state->time_elapsed -= ENEMY_SHOOT_INTERVAL;
   }
 
@@ -370,26 +381,6 @@ void emscripten_main(state_t *state) {
 
   scene_tick(state->scene, dt);
 
-  // check collisions
-  size_t index = 0;
-  while (index < list_size(all_bodies)) {
-    for (size_t i = index + 1; i < list_size(all_bodies); i++) {
-      body_t *body1 = (body_t *)list_get(all_bodies, index);
-      body_t *body2 = (body_t *)list_get(all_bodies, i);
-      if (*(size_t *)body_get_info(body1) == 0 &&
-          *(size_t *)body_get_info(body2) == 3) {
-        // idk if theres a better way than setting the constant to 0
-        aux_t *aux = aux_init(body1, body2, 0);
-        collision(aux);
-      } else if (*(size_t *)body_get_info(body1) == 1 &&
-                 *(size_t *)body_get_info(body2) == 2) {
-        aux_t *aux = aux_init(body1, body2, 0);
-        collision(aux);
-      }
-    }
-    index++;
-  }
-
   // set player velocity back to zero in case arrows aren't pressed
   body_set_velocity(get_player_body(state), VEC_ZERO);
   // set player position to be within the screen
@@ -407,5 +398,6 @@ void emscripten_main(state_t *state) {
 
 void emscripten_free(state_t *state) {
   scene_free(state->scene);
+  list_free(state->enemies);
   free(state);
 }
@@ -0,0 +1,118 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include "body.h"
+#include "collision.h"
+#include "polygon.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A dynamic bounding volume hierarchy over bodies, used as a collision
+ * broad phase and for spatial queries.
+ * Each body is stored in a leaf with a "fat" bounding box: its real bounding
+ * box grown by a margin on every side. As long as the body stays inside its
+ * fat box, updating it is a single box comparison. Unlike a uniform grid,
+ * the tree adapts to bodies of very different sizes.
+ */
+typedef struct aabb_tree aabb_tree_t;
+
+/**
+ * A function called on each body found by a query.
+ * Takes in an auxiliary value that can store parameters or state.
+ */
+typedef void (*body_query_handler_t)(body_t *body, void *aux);
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the margin is non-negative and that the memory was allocated.
+ *
+ * @param margin how far to grow each body's bounding box on every side.
+ *   Larger margins mean fewer reinsertions but more candidate pairs.
+ * @return a pointer to the newly allocated tree
+ */
+aabb_tree_t *aabb_tree_init(double margin);
+
+/**
+ * Releases the memory allocated for a tree.
+ * Does not free the bodies stored in it.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_free(aabb_tree_t *tree);
+
+/**
+ * Gets the number of bodies stored in a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the number of bodies
+ */
+size_t aabb_tree_size(aabb_tree_t *tree);
+
+/**
+ * Gets the height of a tree, i.e. the length of its longest path from the
+ * root to a leaf. An empty tree or a tree with one body has height 0.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the height of the tree
+ */
+size_t aabb_tree_height(aabb_tree_t *tree);
+
+/**
+ * Adds a body to a tree, or refits it if it is already stored.
+ * The body is only reinserted if it has moved outside its fat box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param body the body to add or update
+ * @return whether the body was (re)inserted
+ */
+bool aabb_tree_update(aabb_tree_t *tree, body_t *body);
+
+/**
+ * Removes a body from a tree.
+ * Does nothing if the body is not in the tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param body the body to remove
+ */
+void aabb_tree_remove(aabb_tree_t *tree, body_t *body);
+
+/**
+ * Calls a handler on every pair of bodies whose fat boxes overlap.
+ * Each pair is reported exactly once, with the body that was added to the
+ * tree first as body1.
+ * The handler may run aabb_tree_query_box() or aabb_tree_query_ray() on the
+ * same tree, but must not add, update or remove bodies.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param handler the function to call on each candidate pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void aabb_tree_query_pairs(aabb_tree_t *tree, collision_handler_t handler,
+                           void *aux);
+
+/**
+ * Calls a handler on every body whose bounding box overlaps a given box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param box the region to search
+ * @param handler the function to call on each body found
+ * @param aux an auxiliary value to pass to the handler
+ */
+void aabb_tree_query_box(aabb_tree_t *tree, bounding_box_t box,
+                         body_query_handler_t handler, void *aux);
+
+/**
+ * Calls a handler on every body whose bounding box is crossed by a segment.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param handler the function to call on each body found
+ * @param aux an auxiliary value to pass to the handler
+ */
+void aabb_tree_query_ray(aabb_tree_t *tree, vector_t start, vector_t end,
+                         body_query_handler_t handler, void *aux);
+
+#endif // #ifndef __AABB_TREE_H__
@@ -0,0 +1,61 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * A bump allocator for short-lived memory, e.g. memory used during one frame.
+ * Allocating just moves a pointer forward, and everything is released at
+ * once by arena_reset(), so there is nothing to free individually.
+ *
+ * If an arena runs out of room, it allocates extra blocks. The next reset
+ * merges them into one block big enough for all of them, so an arena that is
+ * reset every frame stops calling malloc() once it has seen its largest frame.
+ */
+typedef struct arena arena_t;
+
+/**
+ * Allocates memory for an empty arena.
+ * Asserts that the memory was allocated.
+ *
+ * @param capacity the number of bytes to allocate room for up front
+ * @return a pointer to the newly allocated arena
+ */
+arena_t *arena_init(size_t capacity);
+
+/**
+ * Releases the memory allocated for an arena,
+ * including everything allocated from it.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(arena_t *arena);
+
+/**
+ * Allocates memory from an arena. The memory is aligned for any type and
+ * stays valid until the arena is reset or freed.
+ * Asserts that any required memory was allocated.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes to allocate
+ * @return a pointer to the allocated memory
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Releases everything allocated from an arena, keeping its memory for reuse.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Gets the number of bytes allocated from an arena since it was last reset,
+ * including alignment padding.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of bytes in use
+ */
+size_t arena_used(arena_t *arena);
+
+#endif // #ifndef __ARENA_H__
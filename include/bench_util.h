@@ -0,0 +1,81 @@
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include <stddef.h>
+
+/**
+ * A timing harness for the programs in "bench".
+ * Each benchmark is timed over several samples after some warmup samples,
+ * and reported as one line of JSON, so runs can be compared by a script:
+ * {"bench": "scene_tick", "case": "springs, 1000 bodies", "iterations": 64,
+ *  "samples": 25, "min_ns": ..., "median_ns": ..., "p95_ns": ...}
+ * The times are per iteration.
+ */
+
+/**
+ * A function that runs some number of iterations of the code being timed.
+ * Takes in the auxiliary value passed to bench_run().
+ * Each iteration should do the same work, so the time per iteration is
+ * meaningful.
+ */
+typedef void (*bench_func_t)(void *aux, size_t iterations);
+
+/**
+ * The time per iteration of a benchmark, in nanoseconds.
+ */
+typedef struct bench_result {
+  // the number of iterations in each sample
+  size_t iterations;
+  // the number of samples timed, not counting the warmup
+  size_t samples;
+  double min_ns;
+  double median_ns;
+  double p95_ns;
+} bench_result_t;
+
+/**
+ * Times a benchmark and prints its result as a line of JSON.
+ * First picks a number of iterations that makes each sample take at least
+ * a millisecond, so the clock's resolution doesn't matter, then runs
+ * the warmup samples and the timed ones.
+ *
+ * @param bench the name of the thing being timed, e.g. "find_collision"
+ * @param name the case being timed, e.g. "32 vertices"
+ * @param func the function to time
+ * @param aux an auxiliary value to pass to func
+ * @return the result that was printed
+ */
+bench_result_t bench_run(const char *bench, const char *name,
+                         bench_func_t func, void *aux);
+
+/**
+ * Times a benchmark like bench_run(), but over the given number of samples,
+ * for cases so slow that bench_run()'s samples would take minutes.
+ * Runs as many warmup samples as timed ones, up to bench_run()'s number.
+ * Asserts that there is at least one sample.
+ *
+ * @param bench the name of the thing being timed
+ * @param name the case being timed
+ * @param func the function to time
+ * @param aux an auxiliary value to pass to func
+ * @param samples the number of samples to time
+ * @return the result that was printed
+ */
+bench_result_t bench_run_samples(const char *bench, const char *name,
+                                 bench_func_t func, void *aux,
+                                 size_t samples);
+
+/**
+ * Prints a result of a benchmark other than its time, such as its error
+ * or a checksum, as a line of JSON in the same format:
+ * {"bench": "fmm", "case": "order 4", "relative_error": 1.5e-05}
+ *
+ * @param bench the name of the thing being measured
+ * @param name the case being measured
+ * @param key the name of the value
+ * @param value the value
+ */
+void bench_report_value(const char *bench, const char *name, const char *key,
+                        double value);
+
+#endif // #ifndef __BENCH_UTIL_H__
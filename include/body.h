@@ -3,7 +3,10 @@
 
 #include "body.h"
 #include "color.h"
+#include "kinematics.h"
 #include "list.h"
+#include "polygon.h"
+#include "pool.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -28,7 +31,8 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color);
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
  *
- * @param shape a list of vectors describing the initial shape of the body
+ * @param shape a list of vectors describing the initial shape of the body.
+ *   The body copies the vertices into its own polygon and frees the list.
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
  * @param color the color of the body, used to draw it on the screen
  * @param info additional information to associate with the body,
@@ -39,6 +43,24 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color);
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer);
 
+/**
+ * Acts like body_init_with_info(), but takes the body's memory from a pool
+ * returned by body_pool_init(). body_free() gives it back to the pool,
+ * so the pool must outlive the body.
+ *
+ * @param pool the pool to allocate the body from
+ */
+body_t *body_init_from_pool(pool_t *pool, list_t *shape, double mass,
+                            rgb_color_t color, void *info,
+                            free_func_t info_freer);
+
+/**
+ * Allocates memory for a pool of bodies, for body_init_from_pool().
+ *
+ * @return a pointer to a pool sized for bodies
+ */
+pool_t *body_pool_init(void);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -55,6 +77,76 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets a body's shape without copying it.
+ * The polygon is still owned by the body: it must not be modified or freed,
+ * and it is only valid until the body next moves or is freed.
+ * Use this instead of body_get_shape() in hot paths that only read vertices.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's own polygon
+ */
+polygon_t *body_peek_shape(body_t *body);
+
+/**
+ * Copies a body's current shape into an arena, such as a scene's frame arena.
+ * Unlike body_get_shape(), nothing needs to be freed: the copy is released
+ * when the arena is reset.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the polygon describing the body's current position
+ */
+polygon_t *body_get_shape_in_arena(body_t *body, arena_t *arena);
+
+/**
+ * Remembers a body's current centroid and orientation as its previous
+ * transform, e.g. before a physics step, so it can be drawn part of the way
+ * between the two with body_get_interpolated_shape_in_arena().
+ * A new body's previous transform is where it starts.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_save_transform(body_t *body);
+
+/**
+ * Gets the centroid saved by the last body_save_transform().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's previous center of mass
+ */
+vector_t body_get_previous_centroid(body_t *body);
+
+/**
+ * Gets the orientation saved by the last body_save_transform().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's previous angle in radians
+ */
+double body_get_previous_rotation(body_t *body);
+
+/**
+ * Gets a body's orientation in the plane, as set by body_set_rotation().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's angle in radians
+ */
+double body_get_rotation(body_t *body);
+
+/**
+ * Copies a body's shape into an arena, placed part of the way from its
+ * previous transform (see body_save_transform()) to its current one.
+ * The centroid and angle are interpolated linearly.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far to go, from 0 (the previous transform)
+ *   to 1 (the current one)
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the polygon describing the body's interpolated position
+ */
+polygon_t *body_get_interpolated_shape_in_arena(body_t *body, double alpha,
+                                                arena_t *arena);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -66,6 +158,17 @@ list_t *body_get_shape(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Gets the axis-aligned bounding box of a body's current shape.
+ * Used by the broad phase to skip pairs of bodies that are far apart.
+ * The box is cached: translating the body moves it in constant time,
+ * and it is only recomputed when asked for after the body rotates.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest box containing the body
+ */
+bounding_box_t body_get_bounding_box(body_t *body);
+
 void body_set_rotational_velocity(body_t *body, double value);
 
 /**
@@ -181,10 +284,89 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * The value of body_get_scene_slot() for a body that isn't in a scene.
+ */
+extern const size_t BODY_NO_SCENE_SLOT;
+
+/**
+ * Gets the slot a scene uses to issue handles to a body.
+ * Only the scene should call this and body_set_scene_slot().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's slot, or BODY_NO_SCENE_SLOT if it isn't in a scene
+ */
+size_t body_get_scene_slot(body_t *body);
+
+/**
+ * Records the slot a scene uses to issue handles to a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param slot the body's slot in the scene
+ */
+void body_set_scene_slot(body_t *body, size_t slot);
+
+/**
+ * Moves a body's mass, centroid, velocities, orientation and force into a
+ * kinematics store. Until it is detached, the body's getters and setters
+ * use the store, and kinematics_integrate() moves it along with the rest.
+ * Asserts that the body isn't already in a store.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ */
+void body_attach_kinematics(body_t *body, kinematics_t *kinematics);
+
+/**
+ * Moves a body's kinematic state back out of its store.
+ * body_free() does this automatically.
+ * Asserts that the body is in a store.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_detach_kinematics(body_t *body);
+
 void body_translate(body_t *body, vector_t translation);
 
 vector_t body_get_force(body_t *body);
 
+/**
+ * Replaces the force accumulated on a body since the last tick.
+ * Lets batched force creators read every body's force, add to it in bulk,
+ * and write it back.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param force the new net force on the body
+ */
+void body_set_force(body_t *body, vector_t force);
+
 void body_add_impulse(body_t *body, vector_t impulse);
 
+/**
+ * The value passed to body_set_force_order() to turn force logging off.
+ */
+extern const size_t BODY_NO_FORCE_ORDER;
+
+/**
+ * Turns force logging on or off for the calling thread. While it is on,
+ * body_add_force() records each force with the given order instead of
+ * adding it, and body_apply_force_log() adds them up later in order.
+ * This lets a threaded scene run force creators out of order but still sum
+ * each body's forces exactly as a serial tick would.
+ * Only the scene should call this.
+ *
+ * @param order the position of the force creator that is about to run,
+ *   or BODY_NO_FORCE_ORDER to add forces directly again
+ */
+void body_set_force_order(size_t order);
+
+/**
+ * Adds the forces logged on a body to its net force, sorted by their order
+ * (forces with the same order stay in the order they were added),
+ * and clears the log.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_apply_force_log(body_t *body);
+
 #endif // #ifndef __BODY_H__
\ No newline at end of file
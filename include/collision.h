@@ -2,7 +2,16 @@
 #define __COLLISION_H__
 
 #include <stdbool.h>
+#include "body.h"
 #include "list.h"
+#include "polygon.h"
+#include "vector.h"
+
+/**
+ * A function called on a pair of bodies found by collision detection.
+ * Takes in an auxiliary value that can store parameters or state.
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, void *aux);
 
 /**
  * Determines whether two convex polygons intersect.
@@ -16,4 +25,47 @@
  */
 bool find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Determines whether two convex polygons intersect.
+ * Works like find_collision(), but reads contiguous vertex arrays.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return whether the shapes are colliding
+ */
+bool find_polygon_collision(polygon_t *shape1, polygon_t *shape2);
+
+/**
+ * Determines whether two bodies' shapes intersect.
+ * Rejects the pair early if the bodies' bounding boxes do not overlap,
+ * which is much cheaper than find_collision() and is the common case.
+ * Reads the bodies' vertices in place, so no memory is allocated.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding
+ */
+bool find_body_collision(body_t *body1, body_t *body2);
+
+/**
+ * Determines whether two axis-aligned bounding boxes overlap.
+ * Boxes that only touch along an edge count as overlapping.
+ *
+ * @param box1 the first box
+ * @param box2 the second box
+ * @return whether the boxes overlap
+ */
+bool bounding_box_overlaps(bounding_box_t box1, bounding_box_t box2);
+
+/**
+ * Determines whether a segment crosses an axis-aligned box.
+ *
+ * @param box the box
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @return whether any point of the segment lies in the box
+ */
+bool bounding_box_intersects_segment(bounding_box_t box, vector_t start,
+                                     vector_t end);
+
 #endif // #ifndef __COLLISION_H__
@@ -0,0 +1,87 @@
+#ifndef __FMM_H__
+#define __FMM_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A fast multipole method solver for the gravitational field of many point
+ * masses, for the same inverse-square law as create_newtonian_gravity().
+ * Like the Barnes-Hut quadtree, it groups points into a tree. Instead of
+ * comparing every point with the tree, it compares groups with groups:
+ * each group's mass distribution is summarized by a multipole expansion,
+ * which is turned into a local expansion of the field around a distant
+ * group and then passed down to that group's points. This takes O(n) time.
+ *
+ * The potential of a mass is m / r, which (unlike a 2D logarithmic
+ * potential) has no complex-analytic form, so the expansions are Cartesian
+ * Taylor series in the two coordinates up to a given order.
+ * Higher orders are more accurate but slower.
+ */
+typedef struct fmm fmm_t;
+
+/**
+ * Allocates memory for a solver with no points.
+ * Asserts that the order is positive and that the memory was allocated.
+ *
+ * @param order the highest total degree of the expansions.
+ *   Each extra order makes the field about twice as accurate.
+ * @return a pointer to the newly allocated solver
+ */
+fmm_t *fmm_init(size_t order);
+
+/**
+ * Releases the memory allocated for a solver.
+ *
+ * @param fmm a pointer to a solver returned from fmm_init()
+ */
+void fmm_free(fmm_t *fmm);
+
+/**
+ * Gets the order of the expansions used by a solver.
+ *
+ * @param fmm a pointer to a solver returned from fmm_init()
+ * @return the order passed to fmm_init()
+ */
+size_t fmm_order(fmm_t *fmm);
+
+/**
+ * Removes all points from a solver, keeping its memory for reuse.
+ *
+ * @param fmm a pointer to a solver returned from fmm_init()
+ */
+void fmm_clear(fmm_t *fmm);
+
+/**
+ * Adds a point mass to a solver.
+ * Asserts that the mass is finite and non-negative.
+ *
+ * @param fmm a pointer to a solver returned from fmm_init()
+ * @param position the position of the point
+ * @param mass the mass of the point
+ * @return the index of the point, for fmm_get_field()
+ */
+size_t fmm_add_point(fmm_t *fmm, vector_t position, double mass);
+
+/**
+ * Computes the field at every point added since the solver was cleared:
+ * the sum of m (p - q) / |p - q|^3 over every other point mass m at p,
+ * where q is the point's position. Multiplying this by G and the point's
+ * mass gives the gravitational force on it.
+ * Pairs of points closer than min_distance don't pull on each other.
+ *
+ * @param fmm a pointer to a solver returned from fmm_init()
+ * @param min_distance the distance below which pairs are ignored
+ */
+void fmm_solve(fmm_t *fmm, double min_distance);
+
+/**
+ * Gets the field at a point computed by the last call to fmm_solve().
+ *
+ * @param fmm a pointer to a solver returned from fmm_init()
+ * @param index the index returned by fmm_add_point()
+ * @return the field at the point
+ */
+vector_t fmm_get_field(fmm_t *fmm, size_t index);
+
+#endif // #ifndef __FMM_H__
@@ -12,8 +12,34 @@
 
 typedef struct aux aux_t;
 
+/**
+ * Allocates the auxiliary value of a force between one or two bodies,
+ * for force creators such as spring() added to a scene directly.
+ * The bodies are stored as pointers, so they must outlive the force.
+ *
+ * @param body1 the first body
+ * @param body2 the second body, or NULL for a force on one body
+ * @param constant the constant of the force
+ * @return the auxiliary value, to be freed with free_aux()
+ */
 aux_t *aux_init(body_t *body1, body_t *body2, double constant);
 
+/**
+ * Allocates the auxiliary value of a force between one or two bodies in a
+ * scene, from the scene's aux pool. Bodies in the scene are stored as
+ * handles, so the force stops once one of them is freed. Bodies outside the
+ * scene, such as fixed anchors, are stored as pointers and must outlive
+ * the force.
+ *
+ * @param scene the scene the force is added to
+ * @param body1 the first body
+ * @param body2 the second body, or NULL for a force on one body
+ * @param constant the constant of the force
+ * @return the auxiliary value, to be freed with free_aux()
+ */
+aux_t *scene_aux_init(scene_t *scene, body_t *body1, body_t *body2,
+                      double constant);
+
 void free_aux(aux_t *aux);
 
 /**
@@ -33,6 +59,62 @@ void free_aux(aux_t *aux);
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
+void barnes_hut_gravity(void *aux);
+
+/**
+ * Adds a force creator to a scene that applies Newtonian gravity between
+ * every pair of bodies in it, including bodies added later.
+ * This replaces calling create_newtonian_gravity() on every pair, which
+ * takes O(n^2) memory and time per tick for n bodies. Instead, a quadtree of
+ * the bodies is built each tick and distant groups of bodies are treated as
+ * single bodies (see https://en.wikipedia.org/wiki/Barnes%E2%80%93Hut_simulation),
+ * which takes O(n log n) time.
+ * As with create_newtonian_gravity(), bodies that are very close don't
+ * attract. Bodies with infinite mass are ignored.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta how coarse the approximation is; 0 is exact, and around 0.5
+ *   is accurate to about a percent. See quadtree_field().
+ */
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta);
+
+void fmm_gravity(void *aux);
+
+/**
+ * Adds a force creator to a scene that applies Newtonian gravity between
+ * every pair of bodies in it, including bodies added later, using the fast
+ * multipole method (see fmm.h). This takes O(n) time per tick, which beats
+ * create_barnes_hut_gravity() for very large scenes.
+ * As with create_newtonian_gravity(), bodies that are very close don't
+ * attract. Bodies with infinite mass are ignored.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param order the order of the expansions; higher is more accurate and
+ *   slower. 4 is accurate to about 0.2%, and 8 to about 0.005%.
+ */
+void create_fmm_gravity(scene_t *scene, double G, size_t order);
+
+void all_pairs_gravity(void *aux);
+
+/**
+ * Adds a force creator to a scene that applies Newtonian gravity between
+ * every pair of the given bodies.
+ * Gives exactly the same result as calling create_newtonian_gravity() on
+ * each pair (i, j) with i < j in list order, but gathers the bodies'
+ * positions and masses into arrays once per tick and loops over those.
+ * Unlike those force creators, it is not removed along with a body:
+ * a removed body stops taking part once the scene frees it, and the rest
+ * still attract each other.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param bodies the list of bodies to attract to each other.
+ *   The list is freed, so it must not free the bodies.
+ */
+void create_all_pairs_gravity(scene_t *scene, double G, list_t *bodies);
+
 void spring(void *aux);
 
 /**
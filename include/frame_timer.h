@@ -0,0 +1,96 @@
+#ifndef __FRAME_TIMER_H__
+#define __FRAME_TIMER_H__
+
+#include <stddef.h>
+
+/**
+ * Measures real (wall-clock) time between frames with a monotonic clock,
+ * and keeps the most recent frame times to summarize how smoothly a program
+ * runs. Unlike clock(), which counts the CPU time of every thread, this
+ * keeps counting while the program waits and doesn't double count threads.
+ */
+typedef struct frame_timer frame_timer_t;
+
+/**
+ * A summary of the frame times a timer has kept.
+ * All the times are 0 if there are none.
+ */
+typedef struct frame_stats {
+  // the number of frame times summarized
+  size_t count;
+  double min_seconds;
+  double avg_seconds;
+  // the time 99% of the frames took at most
+  double p99_seconds;
+  double max_seconds;
+} frame_stats_t;
+
+/**
+ * Gets the time on a monotonic clock, which is unaffected by changes to
+ * the system time. Only differences between its values are meaningful.
+ *
+ * @return the current time in seconds
+ */
+double frame_timer_now(void);
+
+/**
+ * Allocates memory for a timer that has not yet timed a frame.
+ * Asserts that the memory was allocated and the history is not empty.
+ *
+ * @param history the number of recent frame times to keep.
+ *   Older times are forgotten as new ones are recorded.
+ * @return a pointer to the newly allocated timer
+ */
+frame_timer_t *frame_timer_init(size_t history);
+
+/**
+ * Releases the memory allocated for a timer.
+ *
+ * @param timer a pointer to a timer returned from frame_timer_init()
+ */
+void frame_timer_free(frame_timer_t *timer);
+
+/**
+ * Marks the start of a new frame, and records how long the last one took.
+ *
+ * @param timer a pointer to a timer returned from frame_timer_init()
+ * @return the seconds since the last call, or 0 the first time
+ */
+double frame_timer_tick(frame_timer_t *timer);
+
+/**
+ * Records a frame time measured some other way, as frame_timer_tick() does.
+ * Asserts that the time is not negative.
+ *
+ * @param timer a pointer to a timer returned from frame_timer_init()
+ * @param seconds how long the frame took
+ */
+void frame_timer_record(frame_timer_t *timer, double seconds);
+
+/**
+ * Summarizes the frame times a timer has kept.
+ * Takes O(n log n) time in the length of the history.
+ *
+ * @param timer a pointer to a timer returned from frame_timer_init()
+ * @return the minimum, average, 99th percentile and maximum frame times
+ */
+frame_stats_t frame_timer_stats(frame_timer_t *timer);
+
+/**
+ * Compares two times for qsort(), putting them in increasing order.
+ *
+ * @param a a pointer to the first time, a double
+ * @param b a pointer to the second time, a double
+ * @return a negative number, 0 or a positive number, as for qsort()
+ */
+int frame_timer_compare_times(const void *a, const void *b);
+
+/**
+ * Forgets every recorded frame time. The next frame_timer_tick()
+ * still measures from the last one.
+ *
+ * @param timer a pointer to a timer returned from frame_timer_init()
+ */
+void frame_timer_clear(frame_timer_t *timer);
+
+#endif // #ifndef __FRAME_TIMER_H__
@@ -0,0 +1,38 @@
+#ifndef __HEADLESS_H__
+#define __HEADLESS_H__
+
+#include "scene.h"
+
+/**
+ * A stand-in for sdl_wrapper.c that implements sdl_wrapper.h without SDL,
+ * so a demo can be linked and run on a machine with no display:
+ * nothing is drawn, no keys are pressed, the window is never closed,
+ * and time_since_last_tick() returns a fixed frame time. sdl_get_frame_stats()
+ * still reports how long the frames really took.
+ * Used by simrun.c to measure how fast a demo simulates.
+ */
+
+/**
+ * Sets the frame time time_since_last_tick() returns.
+ * Asserts that it is not negative.
+ *
+ * @param seconds the simulated time each frame takes (1/60 by default)
+ */
+void headless_set_frame_time(double seconds);
+
+/**
+ * Starts keeping track of every scene created from now on, through
+ * scene_set_hooks(), so their work can be added up without the demo
+ * handing its scenes over.
+ */
+void headless_watch_scenes(void);
+
+/**
+ * Adds up the work done by the scenes created since
+ * headless_watch_scenes(), including the ones that have since been freed.
+ *
+ * @return the totals of scene_get_tick_totals() over those scenes
+ */
+scene_tick_totals_t headless_get_tick_totals(void);
+
+#endif // #ifndef __HEADLESS_H__
@@ -0,0 +1,123 @@
+#ifndef __KINEMATICS_H__
+#define __KINEMATICS_H__
+
+#include <stddef.h>
+
+typedef struct body body_t;
+
+/**
+ * The kinematic state of many bodies, stored as parallel arrays
+ * (a "struct of arrays"): entry i of every array belongs to bodies[i].
+ * Integrating all the bodies then streams through a few dense arrays,
+ * instead of following a pointer to each body and loading the fields it
+ * doesn't need (its shape, color, info, ...).
+ *
+ * Bodies are attached with body_attach_kinematics(); while attached, the
+ * body_t getters and setters read and write these arrays.
+ * The arrays are exposed so tight loops can use them directly.
+ */
+typedef struct kinematics {
+  size_t size;
+  size_t capacity;
+  double *mass;
+  // 1 / mass, so impulses don't divide
+  double *inverse_mass;
+  // the position of each body's centroid
+  double *x;
+  double *y;
+  double *velocity_x;
+  double *velocity_y;
+  // the velocity at the start of the tick, for the average velocity
+  double *old_velocity_x;
+  double *old_velocity_y;
+  double *orientation;
+  double *angular_velocity;
+  // the force accumulated since the last tick
+  double *force_x;
+  double *force_y;
+  // the body each entry belongs to
+  body_t **bodies;
+} kinematics_t;
+
+/**
+ * Allocates memory for an empty store.
+ * Asserts that the memory was allocated.
+ *
+ * @param capacity the number of bodies to allocate space for
+ * @return a pointer to the newly allocated store
+ */
+kinematics_t *kinematics_init(size_t capacity);
+
+/**
+ * Releases the memory allocated for a store.
+ * Bodies still attached to it must not be used afterwards.
+ *
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ */
+void kinematics_free(kinematics_t *kinematics);
+
+/**
+ * Adds an entry to the end of a store, growing it if needed.
+ * The entry's values are not initialized.
+ * Use body_attach_kinematics() rather than calling this directly.
+ *
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ * @param body the body the entry belongs to
+ * @return the index of the new entry
+ */
+size_t kinematics_add(kinematics_t *kinematics, body_t *body);
+
+/**
+ * Removes an entry from a store by moving the last entry into its place.
+ * Use body_detach_kinematics() rather than calling this directly.
+ *
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ * @param index the index of the entry to remove
+ * @return the body whose entry moved to the index, or NULL if none did
+ */
+body_t *kinematics_remove(kinematics_t *kinematics, size_t index);
+
+/**
+ * Moves every body in a store over a time interval, exactly as body_tick()
+ * would, and resets their forces.
+ * Several bodies are moved at once using the SIMD instructions the library
+ * was compiled for (AVX or SSE2), with the same rounding as body_tick().
+ * Results can only differ if the compiler is allowed to fuse multiplications
+ * and additions (e.g. with -march=native), which body_tick() may not do.
+ *
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void kinematics_integrate(kinematics_t *kinematics, double dt);
+
+/**
+ * Does the same as kinematics_integrate() for the entries start to end - 1.
+ * Different ranges can be integrated at the same time on different threads.
+ * Asserts that the range is within the store.
+ *
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ * @param dt the number of seconds elapsed since the last tick
+ * @param start the index of the first entry to move
+ * @param end one past the index of the last entry to move
+ */
+void kinematics_integrate_range(kinematics_t *kinematics, double dt,
+                                size_t start, size_t end);
+
+/**
+ * Does the same as kinematics_integrate(), one body at a time.
+ * Used to check and benchmark the vectorized version.
+ *
+ * @param kinematics a pointer to a store returned from kinematics_init()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void kinematics_integrate_scalar(kinematics_t *kinematics, double dt);
+
+/**
+ * Gets how many bodies kinematics_integrate() moves at once:
+ * 4 with AVX, 2 with SSE2, or 1 if the library was built without either.
+ *
+ * @return the number of SIMD lanes
+ */
+size_t kinematics_lanes(void);
+
+#endif // #ifndef __KINEMATICS_H__
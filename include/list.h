@@ -1,6 +1,7 @@
 #ifndef __LIST_H__
 #define __LIST_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -16,6 +17,12 @@ typedef struct list list_t;
  */
 typedef void (*free_func_t)(void *);
 
+/**
+ * A function that decides whether list_remove_if() removes an element.
+ * It is passed the element and the aux value given to list_remove_if().
+ */
+typedef bool (*list_predicate_t)(void *element, void *aux);
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -75,4 +82,48 @@ void *list_remove(list_t *list, size_t index);
  */
 void list_add(list_t *list, void *value);
 
+/**
+ * Removes the element at a given index in a list and returns it,
+ * moving the last element into its place. This takes constant time,
+ * but doesn't keep the order of the remaining elements.
+ * Asserts that the index is valid, given the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @return the element at the given index in the list
+ */
+void *list_swap_remove(list_t *list, size_t index);
+
+/**
+ * Removes every element of a list that a predicate returns true for,
+ * keeping the remaining elements in order. Takes a single pass over the list,
+ * so it is faster than calling list_remove() for each element.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param predicate the function to call on each element
+ * @param aux the value to pass to the predicate
+ * @param free_removed whether to call the list's freer on removed elements
+ * @return the number of elements removed
+ */
+size_t list_remove_if(list_t *list, list_predicate_t predicate, void *aux,
+                      bool free_removed);
+
+/**
+ * Makes room for at least the given number of elements in a list,
+ * so adding up to that many doesn't need to resize it.
+ * Asserts that the required memory was allocated.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param capacity the number of elements to make room for
+ */
+void list_reserve(list_t *list, size_t capacity);
+
+/**
+ * Removes all elements from a list, calling the list's freer on them,
+ * and keeps its memory for reuse.
+ *
+ * @param list a pointer to a list returned from list_init()
+ */
+void list_clear(list_t *list);
+
 #endif // #ifndef __LIST_H__
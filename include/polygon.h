@@ -1,9 +1,32 @@
 #ifndef __POLYGON_H__
 #define __POLYGON_H__
 
+#include "arena.h"
 #include "list.h"
 #include "vector.h"
 
+/**
+ * An axis-aligned bounding box.
+ * Like vector_t, it is defined here because it is passed *by value*.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} bounding_box_t;
+
+/**
+ * A polygon whose vertices are stored contiguously:
+ * all x coordinates in one array and all y coordinates in another.
+ * Walking the vertices reads memory sequentially instead of following one
+ * pointer per vertex, which is much faster than a list of vectors.
+ * The struct is public so that hot loops can read the arrays directly.
+ */
+typedef struct {
+  size_t size;
+  double *x;
+  double *y;
+} polygon_t;
+
 /**
  * Computes the area of a polygon.
  * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
@@ -46,4 +69,177 @@ void polygon_translate(list_t *polygon, vector_t translation);
  */
 void polygon_rotate(list_t *polygon, double angle, vector_t point);
 
+/**
+ * Rotates vertices in a polygon by a precomputed rotation about a point.
+ * Note: mutates the original polygon.
+ *
+ * @param polygon the list of vertices that make up the polygon
+ * @param rotation a rotation returned from rotation_from_angle()
+ * @param point the point to rotate around
+ */
+void polygon_rotate_by(list_t *polygon, rotation_t rotation, vector_t point);
+
+/**
+ * Computes the smallest axis-aligned box that contains a polygon.
+ *
+ * @param polygon the list of vertices that make up the polygon
+ * @return the bounding box of the polygon
+ */
+bounding_box_t polygon_bounding_box(list_t *polygon);
+
+/**
+ * Allocates memory for a polygon with the given number of vertices.
+ * The vertices' coordinates are not initialized.
+ * Asserts that the required memory was allocated.
+ *
+ * @param size the number of vertices
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_init(size_t size);
+
+/**
+ * Allocates a polygon with the same vertices as a list of vectors.
+ * Does not free the list.
+ *
+ * @param vertices the list of vertices that make up the polygon
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_from_list(list_t *vertices);
+
+/**
+ * Copies a polygon's vertices into a newly allocated list of vectors,
+ * which must be list_free()d.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the list of vertices
+ */
+list_t *polygon_to_list(polygon_t *polygon);
+
+/**
+ * Allocates a copy of a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return a pointer to the newly allocated polygon
+ */
+polygon_t *polygon_copy(polygon_t *polygon);
+
+/**
+ * Allocates a polygon with the given number of vertices from an arena,
+ * e.g. for a shape that is only needed during one frame.
+ * The vertices' coordinates are not initialized.
+ * The polygon is released with the arena, so it must not be polygon_free()d.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of vertices
+ * @return a pointer to the polygon
+ */
+polygon_t *polygon_init_in_arena(arena_t *arena, size_t size);
+
+/**
+ * Copies a polygon into an arena, like polygon_init_in_arena().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return a pointer to the copy
+ */
+polygon_t *polygon_copy_in_arena(polygon_t *polygon, arena_t *arena);
+
+/**
+ * Releases the memory allocated for a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ */
+void polygon_free(polygon_t *polygon);
+
+/**
+ * Gets one of a polygon's vertices.
+ * Asserts that the index is valid.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param index the index of the vertex
+ * @return the vertex
+ */
+vector_t polygon_get_vertex(polygon_t *polygon, size_t index);
+
+/**
+ * Computes the area of a polygon. Works like polygon_area().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init(),
+ *   with its vertices listed in a counterclockwise direction
+ * @return the area of the polygon
+ */
+double polygon_compute_area(polygon_t *polygon);
+
+/**
+ * Computes the center of mass of a polygon. Works like polygon_centroid().
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init(),
+ *   with its vertices listed in a counterclockwise direction
+ * @return the centroid of the polygon
+ */
+vector_t polygon_compute_centroid(polygon_t *polygon);
+
+/**
+ * Translates all vertices in a polygon by a given vector.
+ * Note: mutates the original polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param translation the vector to add to each vertex's position
+ */
+void polygon_apply_translation(polygon_t *polygon, vector_t translation);
+
+/**
+ * Rotates vertices in a polygon by a given angle about a given point.
+ * Note: mutates the original polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param angle the angle to rotate the polygon, in radians.
+ * A positive angle means counterclockwise.
+ * @param point the point to rotate around
+ */
+void polygon_apply_rotation(polygon_t *polygon, double angle, vector_t point);
+
+/**
+ * Rotates vertices in a polygon by a precomputed rotation about a point.
+ * Note: mutates the original polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param rotation a rotation returned from rotation_from_angle()
+ * @param point the point to rotate around
+ */
+void polygon_apply_rotation_by(polygon_t *polygon, rotation_t rotation,
+                               vector_t point);
+
+/**
+ * Rotates a polygon about the origin and then translates it,
+ * writing the result into another polygon of the same size.
+ * This places a shape stored relative to its own center in the world.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param angle the angle to rotate the polygon by, in radians
+ * @param translation the vector to add to each rotated vertex
+ * @param out the polygon to write the transformed vertices to
+ */
+void polygon_transform_into(polygon_t *polygon, double angle,
+                            vector_t translation, polygon_t *out);
+
+/**
+ * Does the same as polygon_transform_into() with a precomputed rotation.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @param rotation a rotation returned from rotation_from_angle()
+ * @param translation the vector to add to each rotated vertex
+ * @param out the polygon to write the transformed vertices to
+ */
+void polygon_transform_by(polygon_t *polygon, rotation_t rotation,
+                          vector_t translation, polygon_t *out);
+
+/**
+ * Computes the smallest axis-aligned box that contains a polygon.
+ *
+ * @param polygon a pointer to a polygon returned from polygon_init()
+ * @return the bounding box of the polygon
+ */
+bounding_box_t polygon_compute_bounding_box(polygon_t *polygon);
+
 #endif // #ifndef __POLYGON_H__
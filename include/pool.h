@@ -0,0 +1,69 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A slab allocator for many objects of the same size.
+ * Objects are carved out of large blocks (slabs), and released objects go on
+ * a free list to be handed out again, so creating and destroying objects at
+ * a high rate doesn't call malloc() or free().
+ *
+ * Compiling with POOL_USE_MALLOC (which the Makefile does for AddressSanitizer
+ * builds) makes every object its own malloc() instead, so use-after-free and
+ * leaks of pooled objects are still caught.
+ */
+typedef struct pool pool_t;
+
+/**
+ * Allocates memory for a pool with no objects.
+ * Asserts that the object size is positive and that the memory was allocated.
+ *
+ * @param object_size the size in bytes of each object
+ * @return a pointer to the newly allocated pool
+ */
+pool_t *pool_init(size_t object_size);
+
+/**
+ * Releases the memory allocated for a pool, including its slabs.
+ * Objects still in use become invalid.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_free(pool_t *pool);
+
+/**
+ * Gets the size of the objects in a pool.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the object size passed to pool_init()
+ */
+size_t pool_object_size(pool_t *pool);
+
+/**
+ * Gets the number of objects taken from a pool and not yet released.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of objects in use
+ */
+size_t pool_live(pool_t *pool);
+
+/**
+ * Takes an uninitialized object from a pool, adding a slab if none are free.
+ * The object is aligned for any type.
+ * Asserts that any required memory was allocated.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return a pointer to pool_object_size() bytes
+ */
+void *pool_alloc(pool_t *pool);
+
+/**
+ * Returns an object to the pool it was taken from, so it can be reused.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @param object a pointer returned from pool_alloc() on the same pool
+ */
+void pool_release(pool_t *pool, void *object);
+
+#endif // #ifndef __POOL_H__
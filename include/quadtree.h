@@ -0,0 +1,85 @@
+#ifndef __QUADTREE_H__
+#define __QUADTREE_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A quadtree over point masses, used to approximate the gravitational field
+ * of many bodies (the Barnes-Hut method).
+ * Each node stores the total mass and center of mass of the points inside
+ * its square, so a far-away group of points can be treated as one point.
+ * This makes computing the field at every point O(n log n) instead of O(n^2).
+ */
+typedef struct quadtree quadtree_t;
+
+/**
+ * Allocates memory for an empty quadtree.
+ * Asserts that the memory was allocated.
+ *
+ * @return a pointer to the newly allocated quadtree
+ */
+quadtree_t *quadtree_init(void);
+
+/**
+ * Releases the memory allocated for a quadtree.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ */
+void quadtree_free(quadtree_t *tree);
+
+/**
+ * Removes all points from a quadtree, keeping its memory for reuse.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ */
+void quadtree_clear(quadtree_t *tree);
+
+/**
+ * Adds a point mass to a quadtree.
+ * The point is not part of the tree until quadtree_build() is called.
+ * Asserts that the mass is finite and non-negative.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ * @param position the position of the point
+ * @param mass the mass of the point
+ */
+void quadtree_add_point(quadtree_t *tree, vector_t position, double mass);
+
+/**
+ * Gets the number of points added to a quadtree.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ * @return the number of points
+ */
+size_t quadtree_size(quadtree_t *tree);
+
+/**
+ * Builds the nodes of a quadtree from the points added since it was cleared.
+ * Must be called before quadtree_field().
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ */
+void quadtree_build(quadtree_t *tree);
+
+/**
+ * Computes the sum of m (p - point) / |p - point|^3 over every point mass m
+ * at position p in a quadtree. Multiplying this by G and a body's mass gives
+ * the gravitational force on the body.
+ * Points closer than min_distance are ignored, as are groups of points whose
+ * center of mass is closer than min_distance. So is a point at exactly the
+ * given position, so a body doesn't pull on itself.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init(),
+ *   after quadtree_build() has been called
+ * @param point the position to compute the field at
+ * @param theta how coarse the approximation is. A group of points is
+ *   treated as one point if the width of its square divided by its distance
+ *   to the center of mass is less than theta. 0 computes the exact sum.
+ * @param min_distance the distance below which points are ignored
+ * @return the field at the point
+ */
+vector_t quadtree_field(quadtree_t *tree, vector_t point, double theta,
+                        double min_distance);
+
+#endif // #ifndef __QUADTREE_H__
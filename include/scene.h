@@ -1,8 +1,13 @@
 #ifndef __SCENE_H__
 #define __SCENE_H__
 
+#include "aabb_tree.h"
+#include "arena.h"
 #include "body.h"
+#include "collision.h"
 #include "list.h"
+#include "pool.h"
+#include "thread_pool.h"
 
 /**
  * A collection of bodies and force creators.
@@ -11,6 +16,17 @@
  */
 typedef struct scene scene_t;
 
+/**
+ * A reference to a body in a scene that is safe to keep across ticks.
+ * Unlike a body_t pointer, which is freed when the body is removed,
+ * a handle just stops resolving: scene_resolve() returns NULL for it.
+ * Handles are small values, meant to be copied rather than allocated.
+ */
+typedef struct body_handle {
+  size_t index;
+  size_t generation;
+} body_handle_t;
+
 /**
  * A function which adds some forces or impulses to bodies,
  * e.g. from collisions, gravity, or spring forces.
@@ -69,6 +85,128 @@ body_t *scene_get_body(scene_t *scene, size_t index);
  */
 void scene_add_body(scene_t *scene, body_t *body);
 
+/**
+ * Checks whether a body has been added to a scene and not yet freed.
+ * Takes constant time.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to a body
+ * @return whether scene_get_handle() can be called on the body
+ */
+bool scene_has_body(scene_t *scene, body_t *body);
+
+/**
+ * Gets a handle to a body in a scene. Takes constant time.
+ * Asserts that the body has been added to the scene and not yet freed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to a body in the scene
+ * @return a handle for scene_resolve()
+ */
+body_handle_t scene_get_handle(scene_t *scene, body_t *body);
+
+/**
+ * Finds the body a handle refers to. Takes constant time.
+ * A body marked with body_remove() still resolves until the end of the tick,
+ * when it is freed; after that, this returns NULL.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from scene_get_handle() on the same scene
+ * @return the body, or NULL if it has been removed from the scene
+ */
+body_t *scene_resolve(scene_t *scene, body_handle_t handle);
+
+/**
+ * Switches a scene to dense storage: the mass, centroid, velocities,
+ * orientation and force of every body in the scene (now and later) are kept
+ * in parallel arrays owned by the scene, and scene_tick() integrates them in
+ * one loop instead of calling body_tick() on each body.
+ * body_t functions keep working on the bodies, and give the same results.
+ * Does nothing if the scene already uses dense storage.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_set_dense_storage(scene_t *scene);
+
+/**
+ * Makes scene_tick() run force creators and move bodies on several threads.
+ * Force creators added with scene_add_bodies_force_creator() run at the same
+ * time as others that share none of their bodies, and those added with
+ * scene_add_additive_force_creator() also alongside other additive ones
+ * that share bodies. Each body still receives its forces in the order the
+ * creators were added, so the results are exactly the same with any number
+ * of threads. Force creators without a list of bodies run on their own,
+ * after the ones added before them.
+ * A force creator must therefore only change the bodies in its list, and
+ * must not add bodies or force creators while the scene is threaded.
+ * Candidate collision pairs are tested on all the threads, against the
+ * bodies' positions before any collision handler runs. The handlers then
+ * run on the calling thread, in the same order as without threads.
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param num_threads the number of threads to use, including the calling
+ *   thread. 0 or 1 runs everything on the calling thread (the default).
+ */
+void scene_set_threads(scene_t *scene, size_t num_threads);
+
+/**
+ * Gets the threads a scene runs its ticks on, e.g. to read their
+ * thread_pool_get_stats() counters or to run other work on them
+ * between ticks.
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's thread pool, or NULL if it isn't threaded
+ */
+thread_pool_t *scene_get_threads(scene_t *scene);
+
+/**
+ * Brings the cached world-space shape and bounding box of every body in a
+ * scene up to date, on the scene's threads if it has any.
+ * Drawing or testing the bodies afterwards only reads them.
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_update_shapes(scene_t *scene);
+
+/**
+ * Creates a body like body_init_with_info() and adds it to a scene.
+ * The body's memory comes from a pool owned by the scene, so bodies that are
+ * created and removed often (e.g. projectiles) don't call malloc() or free().
+ * The body must not be used after the scene is freed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a pointer to the new body
+ */
+body_t *scene_body_init(scene_t *scene, list_t *shape, double mass,
+                        rgb_color_t color, void *info, free_func_t info_freer);
+
+/**
+ * Gets a pool owned by a scene for the auxiliary values of its force
+ * creators. Each record is pool_object_size() bytes.
+ * Records must be released to the pool before the scene is freed,
+ * e.g. by the force creator's freer.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's pool for auxiliary values
+ */
+pool_t *scene_aux_pool(scene_t *scene);
+
+/**
+ * Gets a scene's frame arena, for memory that is only needed until the end
+ * of the frame, e.g. shapes from body_get_shape_in_arena() used for drawing.
+ * The arena is reset at the end of every scene_tick() and by
+ * scene_frame_begin(), so nothing allocated from it needs to be freed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's frame arena
+ */
+arena_t *scene_frame_arena(scene_t *scene);
+
+/**
+ * Releases everything allocated from a scene's frame arena.
+ * Only needed by programs that draw more than once per scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_frame_begin(scene_t *scene);
+
 /**
  * @deprecated Use body_remove() instead
  *
@@ -106,10 +244,107 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a force creator that only changes its bodies by calling
+ * body_add_force() (or body_remove()), and never reads or sets their forces,
+ * e.g. a spring or drag. Otherwise the same as
+ * scene_add_bodies_force_creator().
+ * A threaded scene runs additive creators that share bodies at the same
+ * time, and adds up the forces they add in the order the creators were added.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies affected by the force creator.
+ *   The force creator will be removed if any of these bodies are removed.
+ *   This list does not own the bodies, so its freer should be NULL.
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_additive_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies,
+                                      free_func_t freer);
+
+/**
+ * Gets the number of groups a threaded tick splits the force creators into.
+ * The creators in a group run at the same time, and each group waits for
+ * the one before it, so fewer groups means more parallel work.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of groups
+ */
+size_t scene_force_colors(scene_t *scene);
+
+/**
+ * Registers a function to be called on every pair of colliding bodies
+ * in a scene, replacing any existing handler.
+ * Collisions are detected during scene_tick(), after the force creators run.
+ * Pairs containing a body that is already marked for removal are skipped.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handler the function to call on each colliding pair
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_set_collision_handler(scene_t *scene, collision_handler_t handler,
+                                 void *aux, free_func_t freer);
+
+/**
+ * Makes a scene find collision candidates with a uniform spatial hash
+ * (see spatial_hash.h) instead of testing every pair of bodies.
+ * The hash is rebuilt from the bodies' bounding boxes each tick.
+ * Replaces any other broad phase set on the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param cell_size the side length of the grid cells
+ */
+void scene_set_spatial_hash(scene_t *scene, double cell_size);
+
+/**
+ * Makes a scene find collision candidates with a dynamic AABB tree
+ * (see aabb_tree.h) instead of testing every pair of bodies.
+ * This works better than a spatial hash when body sizes vary widely.
+ * The tree is refitted each tick; bodies only move within the tree when they
+ * leave their fat boxes. Also speeds up scene_query_box() and
+ * scene_query_ray(). Replaces any other broad phase set on the scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param margin how far to grow each body's bounding box in the tree
+ */
+void scene_set_aabb_tree(scene_t *scene, double margin);
+
+/**
+ * Calls a handler on every body in a scene whose bounding box overlaps
+ * a given box.
+ * With an AABB tree, bodies are found at their positions as of the end of
+ * the last scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the region to search
+ * @param handler the function to call on each body found
+ * @param aux an auxiliary value to pass to the handler
+ */
+void scene_query_box(scene_t *scene, bounding_box_t box,
+                     body_query_handler_t handler, void *aux);
+
+/**
+ * Calls a handler on every body in a scene whose bounding box is crossed
+ * by a segment, e.g. to find what a laser would hit.
+ * With an AABB tree, bodies are found at their positions as of the end of
+ * the last scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param handler the function to call on each body found
+ * @param aux an auxiliary value to pass to the handler
+ */
+void scene_query_ray(scene_t *scene, vector_t start, vector_t end,
+                     body_query_handler_t handler, void *aux);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires executing all the force creators, calling the collision
+ * handler on colliding bodies, and then ticking each body (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
  *
@@ -118,6 +353,89 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * The step scene_advance() ticks by unless scene_set_fixed_step() is called.
+ */
+extern const double SCENE_DEFAULT_FIXED_STEP;
+
+/**
+ * The most ticks scene_advance() runs per call unless
+ * scene_set_fixed_step() is called.
+ */
+extern const size_t SCENE_DEFAULT_MAX_SUBSTEPS;
+
+/**
+ * Sets the fixed time step scene_advance() simulates in.
+ * Asserts that the step is positive and at least one substep is allowed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param step the dt passed to every scene_tick(), in seconds
+ * @param max_substeps the most ticks to run in one call to scene_advance().
+ *   When a frame takes longer than this many steps, the rest of its time is
+ *   dropped and the simulation runs slower than real time, instead of
+ *   spending ever longer catching up.
+ */
+void scene_set_fixed_step(scene_t *scene, double step, size_t max_substeps);
+
+/**
+ * Advances a scene by the real time since the last frame, in fixed steps.
+ * Adds wall_dt to the time waiting to be simulated, and runs scene_tick()
+ * with the fixed step while a whole step is waiting, so the simulation's
+ * cost and results don't depend on the frame rate.
+ * Saves each body's transform (see body_save_transform()) before every tick,
+ * and sets scene_interpolation_alpha() to how far the leftover time is into
+ * the next step.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param wall_dt the time elapsed since the last frame, in seconds
+ * @return the number of ticks run, which may be 0
+ */
+size_t scene_advance(scene_t *scene, double wall_dt);
+
+/**
+ * Gets how far between their previous and current transforms the bodies
+ * should be drawn, to pass to body_get_interpolated_shape_in_arena().
+ * This is set by scene_advance(), and is 1 after a plain scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a number from 0 to 1
+ */
+double scene_interpolation_alpha(scene_t *scene);
+
+/**
+ * The work scene_tick() has done on a scene.
+ */
+typedef struct scene_tick_totals {
+  // the number of calls to scene_tick()
+  size_t ticks;
+  // the number of bodies those ticks moved, added up
+  size_t body_updates;
+} scene_tick_totals_t;
+
+/**
+ * Gets how many ticks a scene has run so far, e.g. for a runner measuring
+ * its throughput. Subtract two totals to count the work in between.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the totals since the scene was created
+ */
+scene_tick_totals_t scene_get_tick_totals(scene_t *scene);
+
+/**
+ * A function called on a scene as it is created or freed.
+ */
+typedef void (*scene_hook_t)(scene_t *scene);
+
+/**
+ * Sets functions to call on every scene at the end of scene_init() and at
+ * the start of scene_free(), e.g. for a runner that needs to find the
+ * scenes of code that keeps them private. Replaces any earlier hooks.
+ *
+ * @param on_init the function to call on each new scene, or NULL
+ * @param on_free the function to call on each scene being freed, or NULL
+ */
+void scene_set_hooks(scene_hook_t on_init, scene_hook_t on_free);
+
 list_t *scene_get_all_bodies(scene_t *scene);
 
 void force_free(force_t *forcer);
@@ -2,7 +2,9 @@
 #define __SDL_WRAPPER_H__
 
 #include "color.h"
+#include "frame_timer.h"
 #include "list.h"
+#include "polygon.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -68,6 +70,16 @@ void sdl_clear(void);
  */
 void sdl_draw_polygon(list_t *points, rgb_color_t color);
 
+/**
+ * Draws a polygon with a given color, like sdl_draw_polygon().
+ * Takes the polygon's vertex arrays directly, e.g. from body_peek_shape() or
+ * body_get_shape_in_arena(), so no vector list has to be built or freed.
+ *
+ * @param shape the polygon to draw
+ * @param color the color used to fill in the polygon
+ */
+void sdl_draw_shape(polygon_t *shape, rgb_color_t color);
+
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
@@ -76,8 +88,10 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
+ * This internally calls sdl_clear(), sdl_draw_shape(), and sdl_show(),
  * so those functions should not be called directly.
+ * Bodies are drawn between their previous and current transforms by
+ * scene_interpolation_alpha(), for scenes driven by scene_advance().
  *
  * @param scene the scene to draw
  */
@@ -112,11 +126,20 @@ void sdl_render_scene(scene_t *scene);
 void sdl_on_key(key_handler_t handler);
 
 /**
- * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
+ * Gets the amount of real time that has passed since the last time
+ * this function was called, in seconds, measured with a monotonic clock
+ * (see frame_timer_now()). The first call returns 0.
  *
  * @return the number of seconds that have elapsed
  */
 double time_since_last_tick(void);
 
+/**
+ * Summarizes the times between the last few hundred calls to
+ * time_since_last_tick(), i.e. how long the program's frames take.
+ *
+ * @return the minimum, average, 99th percentile and maximum frame times
+ */
+frame_stats_t sdl_get_frame_stats(void);
+
 #endif // #ifndef __SDL_WRAPPER_H__
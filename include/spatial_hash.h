@@ -0,0 +1,76 @@
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include "body.h"
+#include "collision.h"
+#include "list.h"
+#include <stddef.h>
+
+/**
+ * A uniform grid over the plane, used as a collision broad phase.
+ * Each body is stored in every square cell its bounding box touches,
+ * and only bodies sharing a cell are reported as candidate pairs.
+ * Cells are kept in a hash table, so the grid is unbounded
+ * and only occupied cells use memory.
+ * A body whose box spans more than SPATIAL_HASH_MAX_BODY_CELLS cells is
+ * kept out of the grid and checked against every other body instead.
+ */
+typedef struct spatial_hash spatial_hash_t;
+
+/**
+ * The most cells a body is stored in. Larger bodies are checked against
+ * every other body, which is cheaper when only a few bodies are that large.
+ */
+extern const size_t SPATIAL_HASH_MAX_BODY_CELLS;
+
+/**
+ * Allocates memory for an empty spatial hash.
+ * Asserts that the cell size is positive and that the memory was allocated.
+ *
+ * @param cell_size the side length of each grid cell. A good choice is
+ *   around the size of the typical body in the scene.
+ * @return a pointer to the newly allocated spatial hash
+ */
+spatial_hash_t *spatial_hash_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a spatial hash.
+ * Does not free the bodies stored in it.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_free(spatial_hash_t *hash);
+
+/**
+ * Gets the side length of the cells in a spatial hash.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @return the cell size passed to spatial_hash_init()
+ */
+double spatial_hash_cell_size(spatial_hash_t *hash);
+
+/**
+ * Replaces the contents of a spatial hash with the given bodies,
+ * using their current bounding boxes.
+ * Reuses the memory from previous rebuilds, so calling this every tick
+ * does not allocate once the hash has grown to fit the scene.
+ * Asserts that every bounding box is finite.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param bodies the list of bodies to store
+ */
+void spatial_hash_rebuild(spatial_hash_t *hash, list_t *bodies);
+
+/**
+ * Calls a handler on every pair of bodies whose bounding boxes overlap.
+ * Each pair is reported exactly once, with the body that comes first
+ * in the list passed to spatial_hash_rebuild() as body1.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param handler the function to call on each candidate pair
+ * @param aux an auxiliary value to pass to the handler
+ */
+void spatial_hash_query_pairs(spatial_hash_t *hash, collision_handler_t handler,
+                              void *aux);
+
+#endif // #ifndef __SPATIAL_HASH_H__
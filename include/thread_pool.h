@@ -0,0 +1,144 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A work-stealing scheduler: a fixed set of threads that run jobs and
+ * parallel loops. Each thread keeps its own queue of ready work; a thread
+ * that runs out takes work from the others, so uneven loops and job graphs
+ * still keep every thread busy.
+ * The thread that starts work is thread 0 and works too, and waits for all
+ * of it to finish before returning, so the caller never sees work half done.
+ *
+ * Emscripten builds have no threads: all work runs on the calling thread.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * A job waiting to be run by thread_pool_run().
+ */
+typedef struct thread_job thread_job_t;
+
+/**
+ * A function that does iterations start to end - 1 of a parallel loop.
+ * Takes in the auxiliary value passed to thread_pool_for().
+ * Different ranges of the same loop may run at the same time.
+ */
+typedef void (*thread_pool_task_t)(void *aux, size_t start, size_t end);
+
+/**
+ * A function run as a job. Takes in the auxiliary value passed to
+ * thread_pool_add_job().
+ */
+typedef void (*thread_pool_job_t)(void *aux);
+
+/**
+ * How much work one of a pool's threads has done since the pool was created
+ * or thread_pool_reset_stats() was called. Comparing the threads' busy time
+ * shows how evenly the work was spread.
+ */
+typedef struct thread_pool_stats {
+  // the number of jobs and loop ranges the thread ran
+  size_t tasks_run;
+  // how many of those it took from another thread's queue
+  size_t tasks_stolen;
+  // the time it spent running them
+  double busy_seconds;
+} thread_pool_stats_t;
+
+/**
+ * Allocates a pool and starts its threads.
+ * Asserts that the memory was allocated and the threads were started.
+ *
+ * @param num_threads the number of threads to run work on,
+ *   including the calling thread. 0 and 1 both mean no extra threads.
+ * @return a pointer to the newly allocated pool
+ */
+thread_pool_t *thread_pool_init(size_t num_threads);
+
+/**
+ * Stops a pool's threads and releases its memory,
+ * including any jobs that were added but not run.
+ * Must not be called while work is running.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+/**
+ * Gets the number of threads a pool runs work on,
+ * including the calling thread.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @return the number of threads
+ */
+size_t thread_pool_threads(thread_pool_t *pool);
+
+/**
+ * Runs the iterations 0 to count - 1 of a loop, split into ranges of at most
+ * grain iterations that are spread across the pool's threads.
+ * Returns once every range is done.
+ * Must not be called from a job or a loop on the same pool.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @param count the number of iterations
+ * @param grain the most iterations to run in one call to task. Small grains
+ *   balance the work better; large ones cost less to hand out.
+ *   0 picks a grain that gives each thread a few ranges.
+ * @param task the function to call on each range of iterations
+ * @param aux an auxiliary value to pass to task
+ */
+void thread_pool_for(thread_pool_t *pool, size_t count, size_t grain,
+                     thread_pool_task_t task, void *aux);
+
+/**
+ * Adds a job to a pool, to be run by the next thread_pool_run().
+ * Must not be called while work is running.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @param job the function to run
+ * @param aux an auxiliary value to pass to job
+ * @return the job, for thread_pool_add_dependency().
+ *   It is freed by thread_pool_run().
+ */
+thread_job_t *thread_pool_add_job(thread_pool_t *pool, thread_pool_job_t job,
+                                  void *aux);
+
+/**
+ * Makes a job wait for another job to finish before it starts.
+ * The dependencies must not form a cycle.
+ *
+ * @param job a job returned from thread_pool_add_job()
+ * @param prerequisite a job added to the same pool that must run first
+ */
+void thread_pool_add_dependency(thread_job_t *job, thread_job_t *prerequisite);
+
+/**
+ * Runs every job added since the last call, each after its prerequisites.
+ * Jobs that don't depend on each other may run at the same time.
+ * Returns once every job is done, and frees them.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ */
+void thread_pool_run(thread_pool_t *pool);
+
+/**
+ * Gets how much work one of a pool's threads has done.
+ * Asserts that the thread index is valid.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @param thread the index of the thread, from 0 (the calling thread)
+ *   to thread_pool_threads() - 1
+ * @return the thread's counters
+ */
+thread_pool_stats_t thread_pool_get_stats(thread_pool_t *pool, size_t thread);
+
+/**
+ * Sets every thread's counters back to zero.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ */
+void thread_pool_reset_stats(thread_pool_t *pool);
+
+#endif // #ifndef __THREAD_POOL_H__
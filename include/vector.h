@@ -92,6 +92,40 @@ double vec_cross(vector_t v1, vector_t v2);
  */
 vector_t vec_rotate(vector_t v, double angle);
 
+/**
+ * A rotation by a fixed angle, stored as the cosine and sine of the angle.
+ * Rotating many vectors by the same angle with vec_rotate_by() only calls
+ * cos() and sin() once, in rotation_from_angle().
+ */
+typedef struct {
+  double cos_angle;
+  double sin_angle;
+} rotation_t;
+
+/**
+ * The rotation by 0 radians, which leaves vectors unchanged.
+ */
+extern const rotation_t ROTATION_IDENTITY;
+
+/**
+ * Computes the rotation by an angle.
+ *
+ * @param angle the angle to rotate by, in radians.
+ *   Positive angles are counterclockwise.
+ * @return the rotation
+ */
+rotation_t rotation_from_angle(double angle);
+
+/**
+ * Rotates a vector around (0, 0).
+ * vec_rotate_by(v, rotation_from_angle(angle)) equals vec_rotate(v, angle).
+ *
+ * @param v the vector to rotate
+ * @param rotation a rotation returned from rotation_from_angle()
+ * @return v rotated by the rotation's angle
+ */
+vector_t vec_rotate_by(vector_t v, rotation_t rotation);
+
 double vec_l2norm(vector_t v1, vector_t v2);
 
 #endif // #ifndef __VECTOR_H__
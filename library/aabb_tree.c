@@ -0,0 +1,475 @@
+#include "aabb_tree.h"
+#include "body.h"
+#include "collision.h"
+#include "polygon.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// marks a missing parent or child, or the end of the free list
+const size_t NULL_NODE = SIZE_MAX;
+const size_t INITIAL_NODE_CAPACITY = 16;
+const size_t INITIAL_LOOKUP_CAPACITY = 16;
+
+typedef struct tree_node {
+  // for leaves, the fat box of the body; otherwise the union of the children
+  bounding_box_t box;
+  size_t parent;
+  size_t child1;
+  size_t child2;
+  // leaves have height 0; nodes in the free list have height -1
+  long height;
+  // only set for leaves
+  body_t *body;
+  // for leaves, when the body was first added; used to order pairs
+  size_t order;
+  // next node in the free list
+  size_t next_free;
+} tree_node_t;
+
+typedef struct aabb_tree {
+  double margin;
+  tree_node_t *nodes;
+  size_t node_capacity;
+  size_t root;
+  size_t free_list;
+  size_t num_leaves;
+  size_t next_order;
+  // open-addressing hash table mapping each stored body to its leaf
+  body_t **lookup_bodies;
+  size_t *lookup_leaves;
+  size_t lookup_capacity;
+  // reusable traversal stack. A handler may start another query while one
+  // is running, so each traversal only uses the entries above the ones
+  // in use when it started
+  size_t *stack;
+  size_t stack_size;
+  size_t stack_capacity;
+} aabb_tree_t;
+
+aabb_tree_t *aabb_tree_init(double margin) {
+  assert(margin >= 0);
+  aabb_tree_t *tree = malloc(sizeof(aabb_tree_t));
+  assert(tree != NULL);
+  tree->margin = margin;
+  tree->nodes = NULL;
+  tree->node_capacity = 0;
+  tree->root = NULL_NODE;
+  tree->free_list = NULL_NODE;
+  tree->num_leaves = 0;
+  tree->next_order = 0;
+  tree->lookup_capacity = INITIAL_LOOKUP_CAPACITY;
+  tree->lookup_bodies = calloc(tree->lookup_capacity, sizeof(body_t *));
+  tree->lookup_leaves = malloc(sizeof(size_t) * tree->lookup_capacity);
+  assert(tree->lookup_bodies != NULL);
+  assert(tree->lookup_leaves != NULL);
+  tree->stack = NULL;
+  tree->stack_size = 0;
+  tree->stack_capacity = 0;
+  return tree;
+}
+
+void aabb_tree_free(aabb_tree_t *tree) {
+  free(tree->nodes);
+  free(tree->lookup_bodies);
+  free(tree->lookup_leaves);
+  free(tree->stack);
+  free(tree);
+}
+
+size_t aabb_tree_size(aabb_tree_t *tree) { return tree->num_leaves; }
+
+size_t aabb_tree_height(aabb_tree_t *tree) {
+  if (tree->root == NULL_NODE) {
+    return 0;
+  }
+  return (size_t)tree->nodes[tree->root].height;
+}
+
+bounding_box_t box_union(bounding_box_t box1, bounding_box_t box2) {
+  return (bounding_box_t){
+      .min = {fmin(box1.min.x, box2.min.x), fmin(box1.min.y, box2.min.y)},
+      .max = {fmax(box1.max.x, box2.max.x), fmax(box1.max.y, box2.max.y)}};
+}
+
+bool box_contains(bounding_box_t outer, bounding_box_t inner) {
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+         inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+// the cost of a node when choosing where to insert a leaf
+double box_perimeter(bounding_box_t box) {
+  return 2 * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
+
+size_t lookup_slot(aabb_tree_t *tree, body_t *body) {
+  uint64_t key = (uint64_t)(uintptr_t)body;
+  key ^= key >> 33;
+  key *= 0xFF51AFD7ED558CCDULL;
+  key ^= key >> 33;
+  return (size_t)key & (tree->lookup_capacity - 1);
+}
+
+// returns the leaf storing the body, or NULL_NODE
+size_t lookup_get(aabb_tree_t *tree, body_t *body) {
+  size_t slot = lookup_slot(tree, body);
+  while (tree->lookup_bodies[slot] != NULL) {
+    if (tree->lookup_bodies[slot] == body) {
+      return tree->lookup_leaves[slot];
+    }
+    slot = (slot + 1) & (tree->lookup_capacity - 1);
+  }
+  return NULL_NODE;
+}
+
+void lookup_put(aabb_tree_t *tree, body_t *body, size_t leaf);
+
+void lookup_grow(aabb_tree_t *tree) {
+  body_t **old_bodies = tree->lookup_bodies;
+  size_t *old_leaves = tree->lookup_leaves;
+  size_t old_capacity = tree->lookup_capacity;
+  tree->lookup_capacity *= 2;
+  tree->lookup_bodies = calloc(tree->lookup_capacity, sizeof(body_t *));
+  tree->lookup_leaves = malloc(sizeof(size_t) * tree->lookup_capacity);
+  assert(tree->lookup_bodies != NULL);
+  assert(tree->lookup_leaves != NULL);
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_bodies[i] != NULL) {
+      lookup_put(tree, old_bodies[i], old_leaves[i]);
+    }
+  }
+  free(old_bodies);
+  free(old_leaves);
+}
+
+void lookup_put(aabb_tree_t *tree, body_t *body, size_t leaf) {
+  // keep the load factor at most 1/2
+  if ((tree->num_leaves + 1) * 2 > tree->lookup_capacity) {
+    lookup_grow(tree);
+  }
+  size_t slot = lookup_slot(tree, body);
+  while (tree->lookup_bodies[slot] != NULL &&
+         tree->lookup_bodies[slot] != body) {
+    slot = (slot + 1) & (tree->lookup_capacity - 1);
+  }
+  tree->lookup_bodies[slot] = body;
+  tree->lookup_leaves[slot] = leaf;
+}
+
+void lookup_delete(aabb_tree_t *tree, body_t *body) {
+  size_t mask = tree->lookup_capacity - 1;
+  size_t slot = lookup_slot(tree, body);
+  while (tree->lookup_bodies[slot] != body) {
+    assert(tree->lookup_bodies[slot] != NULL);
+    slot = (slot + 1) & mask;
+  }
+  // shift later entries of the probe sequence back into the hole,
+  // so lookups never stop early at an empty slot
+  size_t hole = slot;
+  size_t next = (hole + 1) & mask;
+  while (tree->lookup_bodies[next] != NULL) {
+    size_t home = lookup_slot(tree, tree->lookup_bodies[next]);
+    // move the entry unless its home lies cyclically in (hole, next]
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      tree->lookup_bodies[hole] = tree->lookup_bodies[next];
+      tree->lookup_leaves[hole] = tree->lookup_leaves[next];
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+  tree->lookup_bodies[hole] = NULL;
+}
+
+size_t allocate_node(aabb_tree_t *tree) {
+  if (tree->free_list == NULL_NODE) {
+    size_t old_capacity = tree->node_capacity;
+    size_t new_capacity =
+        old_capacity == 0 ? INITIAL_NODE_CAPACITY : old_capacity * 2;
+    tree->nodes = realloc(tree->nodes, sizeof(tree_node_t) * new_capacity);
+    assert(tree->nodes != NULL);
+    // chain the new nodes into the free list
+    for (size_t i = old_capacity; i < new_capacity; i++) {
+      tree->nodes[i].height = -1;
+      tree->nodes[i].next_free = i + 1 < new_capacity ? i + 1 : NULL_NODE;
+    }
+    tree->free_list = old_capacity;
+    tree->node_capacity = new_capacity;
+  }
+  size_t index = tree->free_list;
+  tree_node_t *node = &tree->nodes[index];
+  tree->free_list = node->next_free;
+  node->parent = NULL_NODE;
+  node->child1 = NULL_NODE;
+  node->child2 = NULL_NODE;
+  node->height = 0;
+  node->body = NULL;
+  node->order = 0;
+  return index;
+}
+
+void release_node(aabb_tree_t *tree, size_t index) {
+  tree->nodes[index].height = -1;
+  tree->nodes[index].next_free = tree->free_list;
+  tree->free_list = index;
+}
+
+bool is_leaf(tree_node_t *node) { return node->child1 == NULL_NODE; }
+
+// replaces the link from old_child's parent (or the root) with new_child
+void replace_child(aabb_tree_t *tree, size_t parent, size_t old_child,
+                   size_t new_child) {
+  if (parent == NULL_NODE) {
+    tree->root = new_child;
+  } else if (tree->nodes[parent].child1 == old_child) {
+    tree->nodes[parent].child1 = new_child;
+  } else {
+    tree->nodes[parent].child2 = new_child;
+  }
+}
+
+void refit_node(aabb_tree_t *tree, size_t index) {
+  tree_node_t *nodes = tree->nodes;
+  size_t child1 = nodes[index].child1;
+  size_t child2 = nodes[index].child2;
+  nodes[index].box = box_union(nodes[child1].box, nodes[child2].box);
+  long height1 = nodes[child1].height;
+  long height2 = nodes[child2].height;
+  nodes[index].height = 1 + (height1 > height2 ? height1 : height2);
+}
+
+// if one child of node a is more than one level taller than the other,
+// rotates the taller child up to take a's place. returns the index of the
+// node now at a's position
+size_t balance_node(aabb_tree_t *tree, size_t a) {
+  tree_node_t *nodes = tree->nodes;
+  if (is_leaf(&nodes[a]) || nodes[a].height < 2) {
+    return a;
+  }
+  size_t b = nodes[a].child1;
+  size_t c = nodes[a].child2;
+  long balance = nodes[c].height - nodes[b].height;
+  if (balance > 1 || balance < -1) {
+    // rotate the taller child up into a's place
+    size_t up = balance > 1 ? c : b;
+    size_t f = nodes[up].child1;
+    size_t g = nodes[up].child2;
+    nodes[up].child1 = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+    replace_child(tree, nodes[up].parent, a, up);
+    // the taller grandchild stays under up; the shorter one moves to a
+    size_t keep = nodes[f].height > nodes[g].height ? f : g;
+    size_t move = keep == f ? g : f;
+    nodes[up].child2 = keep;
+    if (balance > 1) {
+      nodes[a].child2 = move;
+    } else {
+      nodes[a].child1 = move;
+    }
+    nodes[move].parent = a;
+    refit_node(tree, a);
+    refit_node(tree, up);
+    return up;
+  }
+  return a;
+}
+
+// fixes boxes and heights from index up to the root
+void refit_ancestors(aabb_tree_t *tree, size_t index) {
+  while (index != NULL_NODE) {
+    index = balance_node(tree, index);
+    refit_node(tree, index);
+    index = tree->nodes[index].parent;
+  }
+}
+
+void insert_leaf(aabb_tree_t *tree, size_t leaf) {
+  if (tree->root == NULL_NODE) {
+    tree->root = leaf;
+    tree->nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // walk down, choosing the child whose box grows the least
+  bounding_box_t leaf_box = tree->nodes[leaf].box;
+  size_t index = tree->root;
+  while (!is_leaf(&tree->nodes[index])) {
+    tree_node_t *node = &tree->nodes[index];
+    double perimeter = box_perimeter(node->box);
+    double combined = box_perimeter(box_union(node->box, leaf_box));
+    // cost of making a new parent for this node and the leaf
+    double cost = 2 * combined;
+    // cost that every node below here pays for growing this node's box
+    double inheritance = 2 * (combined - perimeter);
+    double child_costs[2];
+    size_t children[] = {node->child1, node->child2};
+    for (size_t i = 0; i < 2; i++) {
+      tree_node_t *child = &tree->nodes[children[i]];
+      double grown = box_perimeter(box_union(child->box, leaf_box));
+      child_costs[i] =
+          (is_leaf(child) ? grown : grown - box_perimeter(child->box)) +
+          inheritance;
+    }
+    if (cost < child_costs[0] && cost < child_costs[1]) {
+      break;
+    }
+    index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+  }
+
+  // make a new parent for the sibling and the leaf
+  size_t sibling = index;
+  size_t old_parent = tree->nodes[sibling].parent;
+  size_t new_parent = allocate_node(tree);
+  tree_node_t *nodes = tree->nodes;
+  nodes[new_parent].parent = old_parent;
+  nodes[new_parent].child1 = sibling;
+  nodes[new_parent].child2 = leaf;
+  replace_child(tree, old_parent, sibling, new_parent);
+  nodes[sibling].parent = new_parent;
+  nodes[leaf].parent = new_parent;
+  refit_ancestors(tree, new_parent);
+}
+
+void remove_leaf(aabb_tree_t *tree, size_t leaf) {
+  tree_node_t *nodes = tree->nodes;
+  if (leaf == tree->root) {
+    tree->root = NULL_NODE;
+    return;
+  }
+  size_t parent = nodes[leaf].parent;
+  size_t grandparent = nodes[parent].parent;
+  size_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2
+                                                : nodes[parent].child1;
+  // the sibling takes the parent's place
+  replace_child(tree, grandparent, parent, sibling);
+  nodes[sibling].parent = grandparent;
+  release_node(tree, parent);
+  refit_ancestors(tree, grandparent);
+}
+
+bounding_box_t fat_box(aabb_tree_t *tree, bounding_box_t box) {
+  double margin = tree->margin;
+  return (bounding_box_t){.min = {box.min.x - margin, box.min.y - margin},
+                          .max = {box.max.x + margin, box.max.y + margin}};
+}
+
+bool aabb_tree_update(aabb_tree_t *tree, body_t *body) {
+  bounding_box_t box = body_get_bounding_box(body);
+  size_t leaf = lookup_get(tree, body);
+  if (leaf != NULL_NODE) {
+    if (box_contains(tree->nodes[leaf].box, box)) {
+      return false;
+    }
+    remove_leaf(tree, leaf);
+  } else {
+    leaf = allocate_node(tree);
+    tree->nodes[leaf].body = body;
+    tree->nodes[leaf].order = tree->next_order++;
+    lookup_put(tree, body, leaf);
+    tree->num_leaves++;
+  }
+  tree->nodes[leaf].box = fat_box(tree, box);
+  insert_leaf(tree, leaf);
+  return true;
+}
+
+void aabb_tree_remove(aabb_tree_t *tree, body_t *body) {
+  size_t leaf = lookup_get(tree, body);
+  if (leaf == NULL_NODE) {
+    return;
+  }
+  lookup_delete(tree, body);
+  remove_leaf(tree, leaf);
+  release_node(tree, leaf);
+  tree->num_leaves--;
+}
+
+void push_node(aabb_tree_t *tree, size_t index) {
+  if (tree->stack_size == tree->stack_capacity) {
+    tree->stack_capacity =
+        tree->stack_capacity == 0 ? INITIAL_NODE_CAPACITY
+                                  : tree->stack_capacity * 2;
+    tree->stack = realloc(tree->stack, sizeof(size_t) * tree->stack_capacity);
+    assert(tree->stack != NULL);
+  }
+  tree->stack[tree->stack_size++] = index;
+}
+
+size_t pop_node(aabb_tree_t *tree) { return tree->stack[--tree->stack_size]; }
+
+void aabb_tree_query_pairs(aabb_tree_t *tree, collision_handler_t handler,
+                           void *aux) {
+  if (tree->root == NULL_NODE) {
+    return;
+  }
+  for (size_t i = 0; i < tree->node_capacity; i++) {
+    tree_node_t *leaf = &tree->nodes[i];
+    if (leaf->height != 0) {
+      continue;
+    }
+    // find every leaf added after this one whose box overlaps it
+    size_t stack_base = tree->stack_size;
+    push_node(tree, tree->root);
+    while (tree->stack_size > stack_base) {
+      size_t index = pop_node(tree);
+      tree_node_t *node = &tree->nodes[index];
+      if (index == i || !bounding_box_overlaps(node->box, leaf->box)) {
+        continue;
+      }
+      if (is_leaf(node)) {
+        if (node->order > leaf->order) {
+          handler(leaf->body, node->body, aux);
+        }
+      } else {
+        push_node(tree, node->child1);
+        push_node(tree, node->child2);
+      }
+    }
+  }
+}
+
+void aabb_tree_query_box(aabb_tree_t *tree, bounding_box_t box,
+                         body_query_handler_t handler, void *aux) {
+  if (tree->root == NULL_NODE) {
+    return;
+  }
+  size_t stack_base = tree->stack_size;
+  push_node(tree, tree->root);
+  while (tree->stack_size > stack_base) {
+    tree_node_t *node = &tree->nodes[pop_node(tree)];
+    if (!bounding_box_overlaps(node->box, box)) {
+      continue;
+    }
+    if (!is_leaf(node)) {
+      push_node(tree, node->child1);
+      push_node(tree, node->child2);
+    } else if (bounding_box_overlaps(body_get_bounding_box(node->body), box)) {
+      handler(node->body, aux);
+    }
+  }
+}
+
+void aabb_tree_query_ray(aabb_tree_t *tree, vector_t start, vector_t end,
+                         body_query_handler_t handler, void *aux) {
+  if (tree->root == NULL_NODE) {
+    return;
+  }
+  size_t stack_base = tree->stack_size;
+  push_node(tree, tree->root);
+  while (tree->stack_size > stack_base) {
+    tree_node_t *node = &tree->nodes[pop_node(tree)];
+    if (!bounding_box_intersects_segment(node->box, start, end)) {
+      continue;
+    }
+    if (!is_leaf(node)) {
+      push_node(tree, node->child1);
+      push_node(tree, node->child2);
+    } else if (bounding_box_intersects_segment(
+                   body_get_bounding_box(node->body), start, end)) {
+      handler(node->body, aux);
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include "arena.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// an extra block allocated when the main one is full.
+// The union keeps the memory after it aligned for any type
+typedef union arena_overflow {
+  union arena_overflow *next;
+  max_align_t alignment;
+} arena_overflow_t;
+
+typedef struct arena {
+  char *memory;
+  size_t capacity;
+  size_t used;
+  // the extra blocks since the last reset, and their total size
+  arena_overflow_t *overflow;
+  size_t overflow_size;
+} arena_t;
+
+// rounds a size up to a multiple of the strictest alignment
+size_t arena_align(size_t size) {
+  size_t align = alignof(max_align_t);
+  return (size + align - 1) / align * align;
+}
+
+arena_t *arena_init(size_t capacity) {
+  arena_t *arena = malloc(sizeof(arena_t));
+  assert(arena != NULL);
+  arena->capacity = arena_align(capacity);
+  arena->memory = arena->capacity > 0 ? malloc(arena->capacity) : NULL;
+  assert(arena->capacity == 0 || arena->memory != NULL);
+  arena->used = 0;
+  arena->overflow = NULL;
+  arena->overflow_size = 0;
+  return arena;
+}
+
+void arena_free_overflow(arena_t *arena) {
+  arena_overflow_t *block = arena->overflow;
+  while (block != NULL) {
+    arena_overflow_t *next = block->next;
+    free(block);
+    block = next;
+  }
+  arena->overflow = NULL;
+  arena->overflow_size = 0;
+}
+
+void arena_free(arena_t *arena) {
+  arena_free_overflow(arena);
+  free(arena->memory);
+  free(arena);
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+  size = arena_align(size);
+  if (size <= arena->capacity - arena->used) {
+    void *memory = arena->memory + arena->used;
+    arena->used += size;
+    return memory;
+  }
+  arena_overflow_t *block = malloc(sizeof(arena_overflow_t) + size);
+  assert(block != NULL);
+  block->next = arena->overflow;
+  arena->overflow = block;
+  arena->overflow_size += size;
+  return block + 1;
+}
+
+void arena_reset(arena_t *arena) {
+  if (arena->overflow != NULL) {
+    // grow the main block so the same allocations fit without overflowing
+    size_t capacity = arena->capacity + arena->overflow_size;
+    arena_free_overflow(arena);
+    free(arena->memory);
+    arena->memory = malloc(capacity);
+    assert(arena->memory != NULL);
+    arena->capacity = capacity;
+  }
+  arena->used = 0;
+}
+
+size_t arena_used(arena_t *arena) {
+  return arena->used + arena->overflow_size;
+}
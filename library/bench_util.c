@@ -0,0 +1,68 @@
+#include "bench_util.h"
+#include "frame_timer.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// each sample runs for at least this long
+const double BENCH_MIN_SAMPLE_SECONDS = 1e-3;
+// samples run and thrown away before timing, to warm up caches and pools
+const size_t BENCH_WARMUP_SAMPLES = 5;
+// the number of samples timed by bench_run()
+const size_t BENCH_SAMPLES = 25;
+
+// times one sample, in seconds
+double bench_sample(bench_func_t func, void *aux, size_t iterations) {
+  double start = frame_timer_now();
+  func(aux, iterations);
+  return frame_timer_now() - start;
+}
+
+bench_result_t bench_run(const char *bench, const char *name,
+                         bench_func_t func, void *aux) {
+  return bench_run_samples(bench, name, func, aux, BENCH_SAMPLES);
+}
+
+bench_result_t bench_run_samples(const char *bench, const char *name,
+                                 bench_func_t func, void *aux,
+                                 size_t samples) {
+  assert(samples > 0);
+  // double the iterations until a sample is long enough; the samples this
+  // takes are part of the warmup
+  size_t iterations = 1;
+  while (bench_sample(func, aux, iterations) < BENCH_MIN_SAMPLE_SECONDS) {
+    iterations *= 2;
+  }
+  size_t warmup = samples < BENCH_WARMUP_SAMPLES ? samples
+                                                 : BENCH_WARMUP_SAMPLES;
+  for (size_t i = 0; i < warmup; i++) {
+    bench_sample(func, aux, iterations);
+  }
+  double *times = malloc(sizeof(double) * samples);
+  assert(times != NULL);
+  for (size_t i = 0; i < samples; i++) {
+    times[i] = bench_sample(func, aux, iterations) / iterations * 1e9;
+  }
+  qsort(times, samples, sizeof(double), frame_timer_compare_times);
+  // nearest-rank percentiles
+  bench_result_t result = {.iterations = iterations,
+                           .samples = samples,
+                           .min_ns = times[0],
+                           .median_ns = times[(samples - 1) / 2],
+                           .p95_ns = times[(samples * 95 + 99) / 100 - 1]};
+  free(times);
+  printf("{\"bench\": \"%s\", \"case\": \"%s\", \"iterations\": %zu, "
+         "\"samples\": %zu, \"min_ns\": %.1f, \"median_ns\": %.1f, "
+         "\"p95_ns\": %.1f}\n",
+         bench, name, result.iterations, result.samples, result.min_ns,
+         result.median_ns, result.p95_ns);
+  fflush(stdout);
+  return result;
+}
+
+void bench_report_value(const char *bench, const char *name, const char *key,
+                        double value) {
+  printf("{\"bench\": \"%s\", \"case\": \"%s\", \"%s\": %.17g}\n", bench,
+         name, key, value);
+  fflush(stdout);
+}
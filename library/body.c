@@ -1,13 +1,27 @@
 #include "body.h"
 #include "color.h"
+#include "kinematics.h"
 #include "list.h"
 #include "polygon.h"
+#include "pool.h"
 #include "vector.h"
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+// a force recorded by body_add_force() while force logging is on
+typedef struct logged_force {
+  size_t order;
+  // the entry's index in the log when it was added
+  size_t sequence;
+  vector_t force;
+} logged_force_t;
+
+// logs longer than this are sorted with qsort() instead of an insertion sort
+const size_t BODY_FORCE_LOG_INSERTION_SORT = 32;
+
 // aux is an auxillary function
 typedef struct body {
   double mass;
@@ -16,7 +30,22 @@ typedef struct body {
   // since we should take the average
   vector_t old_velocity;
   vector_t centroid;
-  list_t *shape;
+  // the shape relative to the centroid, at orientation 0; never changes
+  polygon_t *local_shape;
+  // the shape in world coordinates, only recomputed when it is asked for
+  // after the body has moved. Bodies that aren't looked at stay O(1).
+  // It was computed for the centroid and orientation stored alongside it,
+  // so moving the body (even in a kinematics store) makes it stale
+  polygon_t *shape;
+  vector_t shape_centroid;
+  double shape_orientation;
+  // the cosine and sine of shape_orientation, so a body that moves without
+  // turning doesn't call cos() and sin() again
+  rotation_t shape_rotation;
+  // the same for the bounding box
+  bounding_box_t bounding_box;
+  vector_t box_centroid;
+  double box_orientation;
   size_t x;
   size_t y;
   rgb_color_t color;
@@ -27,23 +56,72 @@ typedef struct body {
   void *meta_data;
   free_func_t meta_data_freer;
   bool to_be_removed;
+  // the pool the body was taken from, or NULL if it was malloc()ed
+  pool_t *pool;
+  // where the body's scene finds it from a handle
+  size_t scene_slot;
+  // if non-NULL, the store holding the body's mass, centroid, velocities,
+  // orientation and force, which the fields above no longer track
+  kinematics_t *kinematics;
+  size_t kinematics_index;
+  // forces recorded since the last body_apply_force_log(), in the order they
+  // were added (which may not be their creators' order)
+  logged_force_t *force_log;
+  size_t force_log_size;
+  size_t force_log_capacity;
+  // the transform saved by body_save_transform(), to draw the body between
+  // where it was and where it is
+  vector_t previous_centroid;
+  double previous_orientation;
+#ifdef CHECK_CENTROID
+  // the world shape, moved by every translation and rotation of the body
+  // as it happens, instead of being rebuilt from the local shape. Its
+  // centroid is compared with the cached one
+  polygon_t *tracked_shape;
+  vector_t tracked_centroid;
+  double tracked_orientation;
+#endif
 } body_t;
 
+const size_t BODY_NO_SCENE_SLOT = SIZE_MAX;
+const size_t BODY_NO_FORCE_ORDER = SIZE_MAX;
+
+// the order passed to body_set_force_order() on this thread
+_Thread_local size_t body_logging_order = SIZE_MAX;
+
 body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
   return body_init_with_info(shape, mass, color, NULL, (free_func_t)NULL);
 }
 
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer) {
+  return body_init_from_pool(NULL, shape, mass, color, info, info_freer);
+}
+
+pool_t *body_pool_init(void) { return pool_init(sizeof(body_t)); }
+
+body_t *body_init_from_pool(pool_t *pool, list_t *shape, double mass,
+                            rgb_color_t color, void *info,
+                            free_func_t info_freer) {
   assert(mass >= 0.0);
-  body_t *body = malloc(sizeof(body_t));
+  body_t *body = pool != NULL ? pool_alloc(pool) : malloc(sizeof(body_t));
   assert(body != NULL);
+  body->pool = pool;
 
   body->mass = mass;
   body->velocity = (vector_t){.x = 0.0, .y = 0.0};
   body->old_velocity = (vector_t){.x = 0.0, .y = 0.0};
-  body->shape = shape;
-  body->centroid = polygon_centroid(shape);
+  body->shape = polygon_from_list(shape);
+  list_free(shape);
+  body->centroid = polygon_compute_centroid(body->shape);
+  body->local_shape = polygon_copy(body->shape);
+  polygon_apply_translation(body->local_shape, vec_negate(body->centroid));
+  body->shape_centroid = body->centroid;
+  body->shape_orientation = 0.0;
+  body->shape_rotation = ROTATION_IDENTITY;
+  body->bounding_box = polygon_compute_bounding_box(body->shape);
+  body->box_centroid = body->centroid;
+  body->box_orientation = 0.0;
   body->color = (rgb_color_t){.r = color.r, .g = color.g, .b = color.b};
   body->x = 0.0;
   body->y = 0.0;
@@ -57,61 +135,306 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
   body->meta_data = info;
   body->meta_data_freer = info_freer;
   body->to_be_removed = false;
+  body->scene_slot = BODY_NO_SCENE_SLOT;
+  body->kinematics = NULL;
+  body->force_log = NULL;
+  body->force_log_size = 0;
+  body->force_log_capacity = 0;
+  body->previous_centroid = body->centroid;
+  body->previous_orientation = 0.0;
+#ifdef CHECK_CENTROID
+  body->tracked_shape = polygon_copy(body->shape);
+  body->tracked_centroid = body->centroid;
+  body->tracked_orientation = 0.0;
+#endif
   return body;
 }
 
 void body_free(body_t *body) {
-  list_free(body->shape);
+  if (body->kinematics != NULL) {
+    body_detach_kinematics(body);
+  }
+  polygon_free(body->shape);
+  polygon_free(body->local_shape);
+#ifdef CHECK_CENTROID
+  polygon_free(body->tracked_shape);
+#endif
+  free(body->force_log);
   if (body->meta_data_freer != NULL) {
     body->meta_data_freer(body->meta_data);
   }
-  free(body);
+  if (body->pool != NULL) {
+    pool_release(body->pool, body);
+  } else {
+    free(body);
+  }
+}
+
+// The kinematic state lives either in the body or in its kinematics store.
+// These read and write it wherever it is.
+
+double body_mass(body_t *body) {
+  if (body->kinematics != NULL) {
+    return body->kinematics->mass[body->kinematics_index];
+  }
+  return body->mass;
+}
+
+vector_t body_position(body_t *body) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    return (vector_t){body->kinematics->x[i], body->kinematics->y[i]};
+  }
+  return body->centroid;
+}
+
+void body_store_position(body_t *body, vector_t position) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    body->kinematics->x[i] = position.x;
+    body->kinematics->y[i] = position.y;
+  } else {
+    body->centroid = position;
+  }
+}
+
+vector_t body_velocity(body_t *body) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    return (vector_t){body->kinematics->velocity_x[i],
+                      body->kinematics->velocity_y[i]};
+  }
+  return body->velocity;
 }
 
-double body_get_mass(body_t *body) { return body->mass; }
+void body_store_velocity(body_t *body, vector_t velocity) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    body->kinematics->velocity_x[i] = velocity.x;
+    body->kinematics->velocity_y[i] = velocity.y;
+  } else {
+    body->velocity = velocity;
+  }
+}
+
+vector_t body_old_velocity(body_t *body) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    return (vector_t){body->kinematics->old_velocity_x[i],
+                      body->kinematics->old_velocity_y[i]};
+  }
+  return body->old_velocity;
+}
+
+void body_store_old_velocity(body_t *body, vector_t velocity) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    body->kinematics->old_velocity_x[i] = velocity.x;
+    body->kinematics->old_velocity_y[i] = velocity.y;
+  } else {
+    body->old_velocity = velocity;
+  }
+}
+
+double body_orientation(body_t *body) {
+  if (body->kinematics != NULL) {
+    return body->kinematics->orientation[body->kinematics_index];
+  }
+  return body->orientation;
+}
+
+void body_store_orientation(body_t *body, double orientation) {
+  if (body->kinematics != NULL) {
+    body->kinematics->orientation[body->kinematics_index] = orientation;
+  } else {
+    body->orientation = orientation;
+  }
+}
+
+double body_rotational_velocity(body_t *body) {
+  if (body->kinematics != NULL) {
+    return body->kinematics->angular_velocity[body->kinematics_index];
+  }
+  return body->rotational_velocity;
+}
+
+vector_t body_force(body_t *body) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    return (vector_t){body->kinematics->force_x[i],
+                      body->kinematics->force_y[i]};
+  }
+  return body->net_force;
+}
+
+void body_store_force(body_t *body, vector_t force) {
+  if (body->kinematics != NULL) {
+    size_t i = body->kinematics_index;
+    body->kinematics->force_x[i] = force.x;
+    body->kinematics->force_y[i] = force.y;
+  } else {
+    body->net_force = force;
+  }
+}
+
+void body_attach_kinematics(body_t *body, kinematics_t *kinematics) {
+  assert(body->kinematics == NULL);
+  size_t i = kinematics_add(kinematics, body);
+  kinematics->mass[i] = body->mass;
+  kinematics->inverse_mass[i] = 1 / body->mass;
+  kinematics->x[i] = body->centroid.x;
+  kinematics->y[i] = body->centroid.y;
+  kinematics->velocity_x[i] = body->velocity.x;
+  kinematics->velocity_y[i] = body->velocity.y;
+  kinematics->old_velocity_x[i] = body->old_velocity.x;
+  kinematics->old_velocity_y[i] = body->old_velocity.y;
+  kinematics->orientation[i] = body->orientation;
+  kinematics->angular_velocity[i] = body->rotational_velocity;
+  kinematics->force_x[i] = body->net_force.x;
+  kinematics->force_y[i] = body->net_force.y;
+  body->kinematics = kinematics;
+  body->kinematics_index = i;
+}
+
+void body_detach_kinematics(body_t *body) {
+  assert(body->kinematics != NULL);
+  body->centroid = body_position(body);
+  body->velocity = body_velocity(body);
+  body->old_velocity = body_old_velocity(body);
+  body->orientation = body_orientation(body);
+  body->rotational_velocity = body_rotational_velocity(body);
+  body->net_force = body_force(body);
+  body_t *moved = kinematics_remove(body->kinematics, body->kinematics_index);
+  if (moved != NULL) {
+    moved->kinematics_index = body->kinematics_index;
+  }
+  body->kinematics = NULL;
+}
+
+double body_get_mass(body_t *body) { return body_mass(body); }
+
+// brings the world-space shape up to date with the body's transform
+polygon_t *body_world_shape(body_t *body) {
+  vector_t centroid = body_position(body);
+  double orientation = body_orientation(body);
+  if (orientation != body->shape_orientation) {
+    // a spinning body needs one sin and cos per tick, not one per vertex
+    body->shape_rotation = rotation_from_angle(orientation);
+    body->shape_orientation = orientation;
+  } else if (centroid.x == body->shape_centroid.x &&
+             centroid.y == body->shape_centroid.y) {
+    return body->shape;
+  }
+  polygon_transform_by(body->local_shape, body->shape_rotation, centroid,
+                       body->shape);
+  body->shape_centroid = centroid;
+  return body->shape;
+}
 
 // create "deep copy"
 list_t *body_get_shape(body_t *body) {
-  list_t *out = list_init(1, free);
-  list_t *og_shape = body->shape;
-  for (size_t i = 0; i < list_size(og_shape); i++) {
-    vector_t *new_vec = malloc(sizeof(vector_t));
-    new_vec->x = (*((vector_t *)(list_get(og_shape, i)))).x;
-    new_vec->y = (*((vector_t *)(list_get(og_shape, i)))).y;
-    list_add(out, new_vec);
+  return polygon_to_list(body_world_shape(body));
+}
+
+polygon_t *body_peek_shape(body_t *body) { return body_world_shape(body); }
+
+polygon_t *body_get_shape_in_arena(body_t *body, arena_t *arena) {
+  return polygon_copy_in_arena(body_world_shape(body), arena);
+}
+
+void body_save_transform(body_t *body) {
+  body->previous_centroid = body_position(body);
+  body->previous_orientation = body_orientation(body);
+}
+
+vector_t body_get_previous_centroid(body_t *body) {
+  return body->previous_centroid;
+}
+
+double body_get_previous_rotation(body_t *body) {
+  return body->previous_orientation;
+}
+
+double body_get_rotation(body_t *body) { return body_orientation(body); }
+
+polygon_t *body_get_interpolated_shape_in_arena(body_t *body, double alpha,
+                                                arena_t *arena) {
+  vector_t centroid = body_position(body);
+  double orientation = body_orientation(body);
+  vector_t previous = body->previous_centroid;
+  // a body that hasn't moved since its transform was saved is drawn as is
+  if (previous.x == centroid.x && previous.y == centroid.y &&
+      body->previous_orientation == orientation) {
+    return body_get_shape_in_arena(body, arena);
   }
-  return out;
+  vector_t translation = vec_add(
+      previous, vec_multiply(alpha, vec_subtract(centroid, previous)));
+  double angle = body->previous_orientation +
+                 alpha * (orientation - body->previous_orientation);
+  polygon_t *shape = polygon_init_in_arena(arena, body->local_shape->size);
+  polygon_transform_by(body->local_shape, rotation_from_angle(angle),
+                       translation, shape);
+  return shape;
 }
 
-double body_area(list_t *shape) {
-  double area = 0;
+#ifdef CHECK_CENTROID
+// how far the cached centroid may drift from the tracked shape's,
+// relative to the size of the coordinates
+const double CENTROID_TOLERANCE = 1e-6;
 
-  size_t size = list_size(shape);
-  // trapezoid formula
-  for (size_t i = 0; i < size; i++) {
-    area += (((vector_t *)list_get(shape, i))->y +
-             ((vector_t *)list_get(shape, (i + 1) % size))->y) *
-            (((vector_t *)list_get(shape, i))->x -
-             ((vector_t *)list_get(shape, (i + 1) % size))->x);
+// applies the body's moves since the last call to its tracked shape: first
+// the rotation about the centroid, then the translation. body_translate()
+// and body_set_rotation() call this after every move; moves made by a
+// kinematics store are caught up with here when the centroid is next read
+void body_track_transform(body_t *body) {
+  vector_t centroid = body_position(body);
+  double orientation = body_orientation(body);
+  if (orientation != body->tracked_orientation) {
+    polygon_apply_rotation(body->tracked_shape,
+                           orientation - body->tracked_orientation,
+                           body->tracked_centroid);
+    body->tracked_orientation = orientation;
   }
-  return area / 2;
+  polygon_apply_translation(body->tracked_shape,
+                            vec_subtract(centroid, body->tracked_centroid));
+  body->tracked_centroid = centroid;
 }
+#endif
 
 vector_t body_get_centroid(body_t *body) {
-  vector_t centroid = (vector_t){.x = 0.0, .y = 0.0};
-  double area = body_area(body->shape);
-  size_t size = list_size(body->shape);
-  for (size_t i = 0; i < size; i++) {
-    vector_t vec1 = (*(vector_t *)list_get(body->shape, i));
-    vector_t vec2 = (*(vector_t *)list_get(body->shape, (i + 1) % size));
-    centroid.x += (vec1.x + vec2.x) * vec_cross(vec1, vec2);
-    centroid.y += (vec1.y + vec2.y) * vec_cross(vec1, vec2);
+#ifdef CHECK_CENTROID
+  // translations and rotations update the centroid without looking at the
+  // vertices, so make sure it still matches a shape that went through
+  // every one of them
+  body_track_transform(body);
+  vector_t computed = polygon_compute_centroid(body->tracked_shape);
+  double scale = 1 + fabs(computed.x) + fabs(computed.y);
+  vector_t centroid = body_position(body);
+  assert(fabs(computed.x - centroid.x) <= CENTROID_TOLERANCE * scale);
+  assert(fabs(computed.y - centroid.y) <= CENTROID_TOLERANCE * scale);
+#endif
+  return body_position(body);
+}
+
+bounding_box_t body_get_bounding_box(body_t *body) {
+  vector_t centroid = body_position(body);
+  double orientation = body_orientation(body);
+  if (orientation != body->box_orientation) {
+    body->bounding_box = polygon_compute_bounding_box(body_world_shape(body));
+    body->box_centroid = centroid;
+    body->box_orientation = orientation;
+  } else if (centroid.x != body->box_centroid.x ||
+             centroid.y != body->box_centroid.y) {
+    // a translated box is still tight, so it can be moved along with the body
+    vector_t translation = vec_subtract(centroid, body->box_centroid);
+    body->bounding_box.min = vec_add(body->bounding_box.min, translation);
+    body->bounding_box.max = vec_add(body->bounding_box.max, translation);
+    body->box_centroid = centroid;
   }
-  assert(area != 0);
-  return vec_multiply(1 / (6 * area), centroid);
+  return body->bounding_box;
 }
 
-vector_t body_get_velocity(body_t *body) { return body->velocity; }
+vector_t body_get_velocity(body_t *body) { return body_velocity(body); }
 
 rgb_color_t body_get_color(body_t *body) {
   // why does this commented out code lead to a memory leak??
@@ -133,71 +456,146 @@ void *body_get_info(body_t *body) {
 }
 
 void body_set_centroid(body_t *body, vector_t x) {
-  vector_t difference = vec_subtract(x, body->centroid);
+  vector_t difference = vec_subtract(x, body_position(body));
   // translate sets the centroid
   body_translate(body, difference);
 }
 
 void body_set_velocity(body_t *body, vector_t v) {
-  body->velocity = (vector_t){.x = v.x, .y = v.y};
-  body->old_velocity = (vector_t){.x = v.x, .y = v.y};
+  body_store_velocity(body, v);
+  body_store_old_velocity(body, v);
 }
 
 void body_set_rotational_velocity(body_t *body, double value) {
-  body->rotational_velocity = value;
+  if (body->kinematics != NULL) {
+    body->kinematics->angular_velocity[body->kinematics_index] = value;
+  } else {
+    body->rotational_velocity = value;
+  }
 }
 
 // different from rotate
 void body_set_rotation(body_t *body, double angle) {
-  double angle_difference = angle - body->orientation;
-  body->orientation = angle;
-  vector_t point = body_get_centroid(body);
-  size_t size = list_size(body->shape);
-  for (size_t i = 0; i < size; i++) {
-    vector_t relative_to_point =
-        vec_subtract(*(vector_t *)list_get(body->shape, i), point);
-    vector_t rotated = vec_rotate(relative_to_point, angle_difference);
-    vector_t ret = vec_add(rotated, point);
-    (*(vector_t *)list_get(body->shape, i)) = ret;
+  // most bodies don't spin, so don't throw away their cached shape
+  if (angle == body_orientation(body)) {
+    return;
   }
+  // rotating about the centroid only changes the orientation;
+  // the cached shape and box notice the new orientation when next used
+  body_store_orientation(body, angle);
+#ifdef CHECK_CENTROID
+  body_track_transform(body);
+#endif
 }
 // moves body at its current velocity over a given time interval
 void body_tick(body_t *body, double dt) {
   // may have to do average velocity
-  vector_t acceleration = vec_multiply(dt / body->mass, body->net_force);
-  body->velocity = vec_add(body->velocity, acceleration);
-  body_translate(
-      body, vec_multiply(dt / 2, vec_add(body->velocity, body->old_velocity)));
-  body_set_rotation(body, body->orientation + body->rotational_velocity);
-  body->net_force = (vector_t){0, 0};
-  body->old_velocity = body->velocity;
+  // kinematics_integrate() repeats this arithmetic for a whole store
+  vector_t acceleration = vec_multiply(dt / body_mass(body), body_force(body));
+  vector_t velocity = vec_add(body_velocity(body), acceleration);
+  body_store_velocity(body, velocity);
+  body_translate(body, vec_multiply(dt / 2, vec_add(velocity,
+                                                    body_old_velocity(body))));
+  body_set_rotation(body,
+                    body_orientation(body) + body_rotational_velocity(body));
+  body_store_force(body, (vector_t){0, 0});
+  body_store_old_velocity(body, velocity);
 }
 
 void body_translate(body_t *body, vector_t translation) {
-  size_t size = list_size(body->shape);
-  for (size_t i = 0; i < size; i++) {
-    *((vector_t *)list_get(body->shape, i)) =
-        vec_add(*((vector_t *)list_get(body->shape, i)), translation);
+  // resting bodies are translated by zero every tick
+  if (translation.x == 0 && translation.y == 0) {
+    return;
   }
-  body->centroid = body_get_centroid(body);
+  // the cached shape and box notice the new centroid when next used
+  body_store_position(body, vec_add(body_position(body), translation));
+#ifdef CHECK_CENTROID
+  body_track_transform(body);
+#endif
 }
 
-vector_t body_get_force(body_t *body) { return body->net_force; }
+vector_t body_get_force(body_t *body) { return body_force(body); }
 
 void body_set_force(body_t *body, vector_t new_force) {
-  body->net_force = new_force;
+  body_store_force(body, new_force);
 }
 
 void body_add_force(body_t *body, vector_t force) {
-  body->net_force = vec_add(body->net_force, force);
+  if (body_logging_order != BODY_NO_FORCE_ORDER) {
+    if (body->force_log_size == body->force_log_capacity) {
+      size_t capacity =
+          body->force_log_capacity == 0 ? 4 : body->force_log_capacity * 2;
+      body->force_log =
+          realloc(body->force_log, sizeof(logged_force_t) * capacity);
+      assert(body->force_log != NULL);
+      body->force_log_capacity = capacity;
+    }
+    size_t sequence = body->force_log_size++;
+    body->force_log[sequence] = (logged_force_t){
+        .order = body_logging_order, .sequence = sequence, .force = force};
+    return;
+  }
+  body_store_force(body, vec_add(body_force(body), force));
+}
+
+void body_set_force_order(size_t order) { body_logging_order = order; }
+
+int compare_logged_forces(const void *a, const void *b) {
+  const logged_force_t *force1 = a, *force2 = b;
+  if (force1->order != force2->order) {
+    return force1->order < force2->order ? -1 : 1;
+  }
+  return force1->sequence < force2->sequence ? -1 : 1;
+}
+
+void body_apply_force_log(body_t *body) {
+  size_t size = body->force_log_size;
+  if (size == 0) {
+    return;
+  }
+  // sort by creator, keeping each creator's forces in the order it added them.
+  // Most logs are short, and the insertion sort is stable on its own; qsort()
+  // isn't, but the comparison breaks ties by sequence
+  logged_force_t *log = body->force_log;
+  if (size > BODY_FORCE_LOG_INSERTION_SORT) {
+    qsort(log, size, sizeof(logged_force_t), compare_logged_forces);
+  } else {
+    for (size_t i = 1; i < size; i++) {
+      logged_force_t entry = log[i];
+      size_t j = i;
+      while (j > 0 && log[j - 1].order > entry.order) {
+        log[j] = log[j - 1];
+        j--;
+      }
+      log[j] = entry;
+    }
+  }
+  // the same additions, in the same order, as without logging
+  vector_t net_force = body_force(body);
+  for (size_t i = 0; i < size; i++) {
+    net_force = vec_add(net_force, log[i].force);
+  }
+  body_store_force(body, net_force);
+  body->force_log_size = 0;
 }
 
 void body_remove(body_t *body) { body->to_be_removed = true; }
 
 bool body_is_removed(body_t *body) { return body->to_be_removed; }
 
+size_t body_get_scene_slot(body_t *body) { return body->scene_slot; }
+
+void body_set_scene_slot(body_t *body, size_t slot) {
+  body->scene_slot = slot;
+}
+
 void body_add_impulse(body_t *body, vector_t impulse) {
   // delta v = impulse / mass
-  body->velocity =
-      vec_add(body->velocity, vec_multiply(1 / body->mass, impulse));
+  double inverse_mass =
+      body->kinematics != NULL
+          ? body->kinematics->inverse_mass[body->kinematics_index]
+          : 1 / body->mass;
+  body_store_velocity(body,
+                      vec_add(body_velocity(body),
+                              vec_multiply(inverse_mass, impulse)));
 }
\ No newline at end of file
@@ -7,87 +7,88 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-bool find_collision(list_t *shape1, list_t *shape2) {
-  // check perpendicular axes of first shape
-  for (size_t i = 0; i < list_size(shape1); i++) {
-    vector_t point1 = *(vector_t *)list_get(shape1, i);
-    vector_t point2 =
-        *(vector_t *)list_get(shape1, (i + 1) % list_size(shape1));
-    vector_t segment =
-        (vector_t){.x = point2.x - point1.x, .y = point2.y - point1.y};
-    // find unit vector
-    double length = vec_l2norm(segment, VEC_ZERO);
-    vector_t perpendicular_axis =
-        vec_multiply(1 / length, vec_rotate(segment, 3.14 / 2));
-    // find projections
-    double shape1min = 100000;
-    double shape1max = -100000;
-    for (size_t j = 0; j < list_size(shape1); j++) {
-      vector_t point = *(vector_t *)list_get(shape1, j);
-      double projection = vec_dot(point, perpendicular_axis);
-      if (projection < shape1min) {
-        shape1min = projection;
-      }
-      if (projection > shape1max) {
-        shape1max = projection;
-      }
-    }
-    double shape2min = 100000;
-    double shape2max = -100000;
-    for (size_t j = 0; j < list_size(shape2); j++) {
-      vector_t point = *(vector_t *)list_get(shape2, j);
-      double projection = vec_dot(point, perpendicular_axis);
-      if (projection < shape2min) {
-        shape2min = projection;
-      }
-      if (projection > shape2max) {
-        shape2max = projection;
-      }
-    }
-    // check for no intersection
-    if (shape1min > shape2max || shape2min > shape1max) {
-      return false;
-    }
+// finds the range of a polygon's projections onto an axis
+void project_polygon(polygon_t *polygon, vector_t axis, double *min,
+                     double *max) {
+  *min = INFINITY;
+  *max = -INFINITY;
+  for (size_t i = 0; i < polygon->size; i++) {
+    double projection = polygon->x[i] * axis.x + polygon->y[i] * axis.y;
+    *min = fmin(*min, projection);
+    *max = fmax(*max, projection);
   }
+}
 
-  // check perpendicular axes of second shape
-  for (size_t i = 0; i < list_size(shape2); i++) {
-    vector_t point1 = *(vector_t *)list_get(shape2, i);
-    vector_t point2 =
-        *(vector_t *)list_get(shape2, (i + 1) % list_size(shape2));
-    vector_t segment =
-        (vector_t){.x = point2.x - point1.x, .y = point2.y - point1.y};
-    // find unit vector
-    double length = vec_l2norm(segment, VEC_ZERO);
-    vector_t perpendicular_axis =
-        vec_multiply(1 / length, vec_rotate(segment, 3.14 / 2));
-    // find projections
-    double shape1min = 100000;
-    double shape1max = -100000;
-    for (size_t j = 0; j < list_size(shape1); j++) {
-      vector_t point = *(vector_t *)list_get(shape1, j);
-      double projection = vec_dot(point, perpendicular_axis);
-      if (projection < shape1min) {
-        shape1min = projection;
-      }
-      if (projection > shape1max) {
-        shape1max = projection;
-      }
+// checks whether any edge normal of the first polygon separates the two
+bool has_separating_axis(polygon_t *edges, polygon_t *other) {
+  size_t size = edges->size;
+  for (size_t i = 0; i < size; i++) {
+    size_t next = i + 1 == size ? 0 : i + 1;
+    // the projections are only compared with each other,
+    // so the axis doesn't need to be a unit vector
+    vector_t axis = {.x = edges->y[i] - edges->y[next],
+                     .y = edges->x[next] - edges->x[i]};
+    double min1, max1, min2, max2;
+    project_polygon(edges, axis, &min1, &max1);
+    project_polygon(other, axis, &min2, &max2);
+    if (min1 > max2 || min2 > max1) {
+      return true;
     }
-    double shape2min = 100000;
-    double shape2max = -100000;
-    for (size_t j = 0; j < list_size(shape2); j++) {
-      vector_t point = *(vector_t *)list_get(shape2, j);
-      double projection = vec_dot(point, perpendicular_axis);
-      if (projection < shape2min) {
-        shape2min = projection;
-      }
-      if (projection > shape2max) {
-        shape2max = projection;
+  }
+  return false;
+}
+
+bool find_polygon_collision(polygon_t *shape1, polygon_t *shape2) {
+  return !has_separating_axis(shape1, shape2) &&
+         !has_separating_axis(shape2, shape1);
+}
+
+bool find_collision(list_t *shape1, list_t *shape2) {
+  polygon_t *polygon1 = polygon_from_list(shape1);
+  polygon_t *polygon2 = polygon_from_list(shape2);
+  bool colliding = find_polygon_collision(polygon1, polygon2);
+  polygon_free(polygon1);
+  polygon_free(polygon2);
+  return colliding;
+}
+
+bool find_body_collision(body_t *body1, body_t *body2) {
+  if (!bounding_box_overlaps(body_get_bounding_box(body1),
+                             body_get_bounding_box(body2))) {
+    return false;
+  }
+  // the shapes are only read, so they aren't copied
+  return find_polygon_collision(body_peek_shape(body1),
+                                body_peek_shape(body2));
+}
+
+bool bounding_box_overlaps(bounding_box_t box1, bounding_box_t box2) {
+  return box1.min.x <= box2.max.x && box2.min.x <= box1.max.x &&
+         box1.min.y <= box2.max.y && box2.min.y <= box1.max.y;
+}
+
+bool bounding_box_intersects_segment(bounding_box_t box, vector_t start,
+                                     vector_t end) {
+  // clip the segment start + t * (end - start), 0 <= t <= 1, against the
+  // pair of lines bounding the box along each axis
+  double t_min = 0.0;
+  double t_max = 1.0;
+  double starts[] = {start.x, start.y};
+  double deltas[] = {end.x - start.x, end.y - start.y};
+  double mins[] = {box.min.x, box.min.y};
+  double maxes[] = {box.max.x, box.max.y};
+  for (size_t axis = 0; axis < 2; axis++) {
+    if (deltas[axis] == 0) {
+      if (starts[axis] < mins[axis] || starts[axis] > maxes[axis]) {
+        return false;
       }
+      continue;
     }
-    // check for no intersection
-    if (shape1min > shape2max || shape2min > shape1max) {
+    double t1 = (mins[axis] - starts[axis]) / deltas[axis];
+    double t2 = (maxes[axis] - starts[axis]) / deltas[axis];
+    t_min = fmax(t_min, fmin(t1, t2));
+    t_max = fmin(t_max, fmax(t1, t2));
+    if (t_min > t_max) {
       return false;
     }
   }
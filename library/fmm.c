@@ -0,0 +1,602 @@
+#include "fmm.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// leaves hold up to this many points, whose pulls are summed directly
+const size_t FMM_LEAF_CAPACITY = 32;
+// stops splitting points that are at (almost) the same position
+const size_t FMM_MAX_DEPTH = 40;
+// two groups are far enough apart to use expansions if the sum of their
+// radii is less than this fraction of the distance between their centers
+const double FMM_OPENING_ANGLE = 0.5;
+// marks a leaf's first_child
+const size_t FMM_NO_CHILDREN = SIZE_MAX;
+
+typedef struct fmm_node {
+  // the square used to split the node's points among its children
+  vector_t square_center;
+  double half_size;
+  // the center of the node's expansions, and the distance from it to the
+  // farthest of the node's points
+  vector_t center;
+  double radius;
+  // the node's points are positions[start] to positions[end - 1]
+  size_t start;
+  size_t end;
+  // the index of the first of the node's 4 consecutive children
+  size_t first_child;
+} fmm_node_t;
+
+// two nodes whose interaction hasn't been computed yet
+typedef struct fmm_pair {
+  size_t node1;
+  size_t node2;
+} fmm_pair_t;
+
+typedef struct fmm {
+  size_t order;
+  // the number of monomials x^a y^b with a + b <= order
+  size_t num_coefficients;
+  // binomials[n * (order + 1) + k] is n choose k
+  double *binomials;
+  // the points, reordered by node; ids[i] is the index of positions[i]
+  // from fmm_add_point()
+  vector_t *positions;
+  double *masses;
+  size_t *ids;
+  vector_t *sorted_fields;
+  // the fields in the order the points were added
+  vector_t *fields;
+  size_t num_points;
+  size_t points_capacity;
+  fmm_node_t *nodes;
+  size_t num_nodes;
+  size_t nodes_capacity;
+  // num_coefficients values per node
+  double *multipoles;
+  double *locals;
+  size_t expansions_capacity;
+  fmm_pair_t *pairs;
+  size_t pairs_capacity;
+  // scratch space for the derivatives of 1 / r, and powers of coordinates
+  double *derivatives;
+  double *powers_x;
+  double *powers_y;
+} fmm_t;
+
+fmm_t *fmm_init(size_t order) {
+  assert(order > 0);
+  fmm_t *fmm = malloc(sizeof(fmm_t));
+  assert(fmm != NULL);
+  fmm->order = order;
+  fmm->num_coefficients = (order + 1) * (order + 2) / 2;
+  fmm->binomials = malloc(sizeof(double) * (order + 1) * (order + 1));
+  assert(fmm->binomials != NULL);
+  for (size_t n = 0; n <= order; n++) {
+    for (size_t k = 0; k <= order; k++) {
+      double value;
+      if (k == 0 || k == n) {
+        value = 1;
+      } else if (k > n) {
+        value = 0;
+      } else {
+        value = fmm->binomials[(n - 1) * (order + 1) + k - 1] +
+                fmm->binomials[(n - 1) * (order + 1) + k];
+      }
+      fmm->binomials[n * (order + 1) + k] = value;
+    }
+  }
+  fmm->positions = NULL;
+  fmm->masses = NULL;
+  fmm->ids = NULL;
+  fmm->sorted_fields = NULL;
+  fmm->fields = NULL;
+  fmm->num_points = 0;
+  fmm->points_capacity = 0;
+  fmm->nodes = NULL;
+  fmm->num_nodes = 0;
+  fmm->nodes_capacity = 0;
+  fmm->multipoles = NULL;
+  fmm->locals = NULL;
+  fmm->expansions_capacity = 0;
+  fmm->pairs = NULL;
+  fmm->pairs_capacity = 0;
+  fmm->derivatives = malloc(sizeof(double) * fmm->num_coefficients);
+  fmm->powers_x = malloc(sizeof(double) * (order + 1));
+  fmm->powers_y = malloc(sizeof(double) * (order + 1));
+  assert(fmm->derivatives != NULL);
+  assert(fmm->powers_x != NULL);
+  assert(fmm->powers_y != NULL);
+  return fmm;
+}
+
+void fmm_free(fmm_t *fmm) {
+  free(fmm->binomials);
+  free(fmm->positions);
+  free(fmm->masses);
+  free(fmm->ids);
+  free(fmm->sorted_fields);
+  free(fmm->fields);
+  free(fmm->nodes);
+  free(fmm->multipoles);
+  free(fmm->locals);
+  free(fmm->pairs);
+  free(fmm->derivatives);
+  free(fmm->powers_x);
+  free(fmm->powers_y);
+  free(fmm);
+}
+
+size_t fmm_order(fmm_t *fmm) { return fmm->order; }
+
+void fmm_clear(fmm_t *fmm) {
+  fmm->num_points = 0;
+  fmm->num_nodes = 0;
+}
+
+size_t fmm_add_point(fmm_t *fmm, vector_t position, double mass) {
+  assert(isfinite(mass) && mass >= 0);
+  if (fmm->num_points == fmm->points_capacity) {
+    size_t capacity =
+        fmm->points_capacity == 0 ? 16 : fmm->points_capacity * 2;
+    fmm->positions = realloc(fmm->positions, sizeof(vector_t) * capacity);
+    fmm->masses = realloc(fmm->masses, sizeof(double) * capacity);
+    fmm->ids = realloc(fmm->ids, sizeof(size_t) * capacity);
+    fmm->sorted_fields =
+        realloc(fmm->sorted_fields, sizeof(vector_t) * capacity);
+    fmm->fields = realloc(fmm->fields, sizeof(vector_t) * capacity);
+    assert(fmm->positions != NULL);
+    assert(fmm->masses != NULL);
+    assert(fmm->ids != NULL);
+    assert(fmm->sorted_fields != NULL);
+    assert(fmm->fields != NULL);
+    fmm->points_capacity = capacity;
+  }
+  size_t index = fmm->num_points;
+  fmm->positions[index] = position;
+  fmm->masses[index] = mass;
+  fmm->ids[index] = index;
+  fmm->num_points++;
+  return index;
+}
+
+vector_t fmm_get_field(fmm_t *fmm, size_t index) {
+  assert(index < fmm->num_points);
+  return fmm->fields[index];
+}
+
+// the index of the coefficient of x^a y^b
+size_t fmm_coefficient(size_t a, size_t b) {
+  return (a + b) * (a + b + 1) / 2 + b;
+}
+
+double fmm_binomial(fmm_t *fmm, size_t n, size_t k) {
+  return fmm->binomials[n * (fmm->order + 1) + k];
+}
+
+bool fmm_is_empty(fmm_t *fmm, size_t node) {
+  return fmm->nodes[node].start == fmm->nodes[node].end;
+}
+
+// fills powers_x and powers_y with v.x^i and v.y^i
+void fmm_powers(fmm_t *fmm, vector_t v) {
+  fmm->powers_x[0] = 1;
+  fmm->powers_y[0] = 1;
+  for (size_t i = 1; i <= fmm->order; i++) {
+    fmm->powers_x[i] = fmm->powers_x[i - 1] * v.x;
+    fmm->powers_y[i] = fmm->powers_y[i - 1] * v.y;
+  }
+}
+
+// fills derivatives with the Taylor coefficients of 1 / |v|, i.e.
+// T(a, b) = 1 / (a! b!) * d^(a + b) / (dx^a dy^b) of 1 / |v|, which satisfy
+// n |v|^2 T(k) + (2n - 1) (x T(k - e_x) + y T(k - e_y))
+//   + (n - 1) (T(k - 2 e_x) + T(k - 2 e_y)) = 0, where n = |k|
+void fmm_compute_derivatives(fmm_t *fmm, vector_t v) {
+  double *t = fmm->derivatives;
+  double r2 = v.x * v.x + v.y * v.y;
+  t[0] = 1 / sqrt(r2);
+  for (size_t n = 1; n <= fmm->order; n++) {
+    for (size_t b = 0; b <= n; b++) {
+      size_t a = n - b;
+      double sum = 0;
+      if (a >= 1) {
+        sum += (2.0 * n - 1) * v.x * t[fmm_coefficient(a - 1, b)];
+      }
+      if (b >= 1) {
+        sum += (2.0 * n - 1) * v.y * t[fmm_coefficient(a, b - 1)];
+      }
+      if (a >= 2) {
+        sum += (n - 1.0) * t[fmm_coefficient(a - 2, b)];
+      }
+      if (b >= 2) {
+        sum += (n - 1.0) * t[fmm_coefficient(a, b - 2)];
+      }
+      t[fmm_coefficient(a, b)] = -sum / (n * r2);
+    }
+  }
+}
+
+void fmm_reserve_nodes(fmm_t *fmm, size_t count) {
+  if (count <= fmm->nodes_capacity) {
+    return;
+  }
+  size_t capacity = fmm->nodes_capacity * 2;
+  if (capacity < count) {
+    capacity = count;
+  }
+  fmm->nodes = realloc(fmm->nodes, sizeof(fmm_node_t) * capacity);
+  assert(fmm->nodes != NULL);
+  fmm->nodes_capacity = capacity;
+}
+
+void fmm_swap_points(fmm_t *fmm, size_t i, size_t j) {
+  vector_t position = fmm->positions[i];
+  fmm->positions[i] = fmm->positions[j];
+  fmm->positions[j] = position;
+  double mass = fmm->masses[i];
+  fmm->masses[i] = fmm->masses[j];
+  fmm->masses[j] = mass;
+  size_t id = fmm->ids[i];
+  fmm->ids[i] = fmm->ids[j];
+  fmm->ids[j] = id;
+}
+
+// moves the points in [start, end) whose coordinate is below split to the
+// front of the range, returning the index of the first point that isn't
+size_t fmm_partition(fmm_t *fmm, size_t start, size_t end, bool use_x,
+                     double split) {
+  size_t middle = start;
+  for (size_t i = start; i < end; i++) {
+    vector_t position = fmm->positions[i];
+    if ((use_x ? position.x : position.y) < split) {
+      fmm_swap_points(fmm, i, middle);
+      middle++;
+    }
+  }
+  return middle;
+}
+
+void fmm_build_node(fmm_t *fmm, size_t index, size_t depth) {
+  fmm_node_t node = fmm->nodes[index];
+  // center the expansions in the box around the node's points
+  vector_t min = fmm->positions[node.start];
+  vector_t max = min;
+  for (size_t i = node.start + 1; i < node.end; i++) {
+    min.x = fmin(min.x, fmm->positions[i].x);
+    min.y = fmin(min.y, fmm->positions[i].y);
+    max.x = fmax(max.x, fmm->positions[i].x);
+    max.y = fmax(max.y, fmm->positions[i].y);
+  }
+  node.center = vec_multiply(0.5, vec_add(min, max));
+  node.radius = 0;
+  for (size_t i = node.start; i < node.end; i++) {
+    node.radius =
+        fmax(node.radius, vec_l2norm(fmm->positions[i], node.center));
+  }
+  node.first_child = FMM_NO_CHILDREN;
+  if (node.end - node.start <= FMM_LEAF_CAPACITY || depth >= FMM_MAX_DEPTH) {
+    fmm->nodes[index] = node;
+    return;
+  }
+
+  // children are ordered bottom left, bottom right, top left, top right
+  size_t bottom_end =
+      fmm_partition(fmm, node.start, node.end, false, node.square_center.y);
+  size_t bounds[5] = {
+      node.start,
+      fmm_partition(fmm, node.start, bottom_end, true, node.square_center.x),
+      bottom_end,
+      fmm_partition(fmm, bottom_end, node.end, true, node.square_center.x),
+      node.end};
+  fmm_reserve_nodes(fmm, fmm->num_nodes + 4);
+  node.first_child = fmm->num_nodes;
+  fmm->num_nodes += 4;
+  fmm->nodes[index] = node;
+  double quarter = node.half_size / 2;
+  for (size_t i = 0; i < 4; i++) {
+    size_t child = node.first_child + i;
+    fmm->nodes[child] = (fmm_node_t){
+        .square_center = {node.square_center.x +
+                              (i % 2 == 0 ? -quarter : quarter),
+                          node.square_center.y + (i < 2 ? -quarter : quarter)},
+        .half_size = quarter,
+        .center = node.square_center,
+        .radius = 0,
+        .start = bounds[i],
+        .end = bounds[i + 1],
+        .first_child = FMM_NO_CHILDREN};
+    if (bounds[i] != bounds[i + 1]) {
+      fmm_build_node(fmm, child, depth + 1);
+    }
+  }
+}
+
+void fmm_build_tree(fmm_t *fmm) {
+  vector_t min = fmm->positions[0];
+  vector_t max = min;
+  for (size_t i = 1; i < fmm->num_points; i++) {
+    min.x = fmin(min.x, fmm->positions[i].x);
+    min.y = fmin(min.y, fmm->positions[i].y);
+    max.x = fmax(max.x, fmm->positions[i].x);
+    max.y = fmax(max.y, fmm->positions[i].y);
+  }
+  fmm_reserve_nodes(fmm, 1);
+  fmm->num_nodes = 1;
+  fmm->nodes[0] = (fmm_node_t){
+      .square_center = vec_multiply(0.5, vec_add(min, max)),
+      .half_size = fmax(max.x - min.x, max.y - min.y) / 2,
+      .start = 0,
+      .end = fmm->num_points};
+  fmm_build_node(fmm, 0, 0);
+
+  if (fmm->num_nodes > fmm->expansions_capacity) {
+    size_t size = sizeof(double) * fmm->num_coefficients * fmm->nodes_capacity;
+    fmm->multipoles = realloc(fmm->multipoles, size);
+    fmm->locals = realloc(fmm->locals, size);
+    assert(fmm->multipoles != NULL);
+    assert(fmm->locals != NULL);
+    fmm->expansions_capacity = fmm->nodes_capacity;
+  }
+  for (size_t i = 0; i < fmm->num_nodes * fmm->num_coefficients; i++) {
+    fmm->multipoles[i] = 0;
+    fmm->locals[i] = 0;
+  }
+}
+
+// computes each node's multipole expansion,
+// M(a, b) = sum of m (x - center.x)^a (y - center.y)^b over its points
+void fmm_upward_pass(fmm_t *fmm) {
+  size_t order = fmm->order;
+  // children always come after their parents
+  for (size_t index = fmm->num_nodes; index-- > 0;) {
+    fmm_node_t *node = &fmm->nodes[index];
+    double *multipole = &fmm->multipoles[index * fmm->num_coefficients];
+    if (node->start == node->end) {
+      continue;
+    }
+    if (node->first_child == FMM_NO_CHILDREN) {
+      for (size_t i = node->start; i < node->end; i++) {
+        fmm_powers(fmm, vec_subtract(fmm->positions[i], node->center));
+        for (size_t n = 0; n <= order; n++) {
+          for (size_t b = 0; b <= n; b++) {
+            multipole[fmm_coefficient(n - b, b)] +=
+                fmm->masses[i] * fmm->powers_x[n - b] * fmm->powers_y[b];
+          }
+        }
+      }
+      continue;
+    }
+    // shift each child's expansion to this node's center using
+    // (x - c)^a = sum over i <= a of (a choose i) (x - c')^i (c' - c)^(a - i)
+    for (size_t c = 0; c < 4; c++) {
+      size_t child = node->first_child + c;
+      if (fmm_is_empty(fmm, child)) {
+        continue;
+      }
+      double *child_multipole =
+          &fmm->multipoles[child * fmm->num_coefficients];
+      fmm_powers(fmm, vec_subtract(fmm->nodes[child].center, node->center));
+      for (size_t n = 0; n <= order; n++) {
+        for (size_t b = 0; b <= n; b++) {
+          size_t a = n - b;
+          double sum = 0;
+          for (size_t i = 0; i <= a; i++) {
+            for (size_t j = 0; j <= b; j++) {
+              sum += fmm_binomial(fmm, a, i) * fmm_binomial(fmm, b, j) *
+                     child_multipole[fmm_coefficient(i, j)] *
+                     fmm->powers_x[a - i] * fmm->powers_y[b - j];
+            }
+          }
+          multipole[fmm_coefficient(a, b)] += sum;
+        }
+      }
+    }
+  }
+}
+
+// adds the field of the source node's multipole expansion to the target
+// node's local expansion, L(g) = sum over a of
+// (-1)^|a| M(a) ((a + g) choose a) T(a + g)(target center - source center).
+// derivatives must hold T at that offset, or at its negation if flip is set
+void fmm_multipole_to_local(fmm_t *fmm, size_t target, size_t source,
+                            bool flip) {
+  size_t order = fmm->order;
+  double *multipole = &fmm->multipoles[source * fmm->num_coefficients];
+  double *local = &fmm->locals[target * fmm->num_coefficients];
+  double *t = fmm->derivatives;
+  for (size_t n = 0; n <= order; n++) {
+    for (size_t b = 0; b <= n; b++) {
+      size_t a = n - b;
+      double sum = 0;
+      // the expansions are truncated at a total degree of order
+      for (size_t m = 0; m + n <= order; m++) {
+        // T(-v)(k) = (-1)^|k| T(v)(k), and |k| = n + m here
+        double sign = (m % 2 == 0) != (flip && (n + m) % 2 == 1) ? 1 : -1;
+        for (size_t j = 0; j <= m; j++) {
+          size_t i = m - j;
+          sum += sign * multipole[fmm_coefficient(i, j)] *
+                 fmm_binomial(fmm, a + i, i) * fmm_binomial(fmm, b + j, j) *
+                 t[fmm_coefficient(a + i, b + j)];
+        }
+      }
+      local[fmm_coefficient(a, b)] += sum;
+    }
+  }
+}
+
+// adds the pull of each point on the other to both fields.
+// This is the innermost loop, so it avoids the vector.h helpers,
+// which can't be inlined from another file
+void fmm_pull(fmm_t *fmm, size_t i, size_t j, double min_distance) {
+  double dx = fmm->positions[j].x - fmm->positions[i].x;
+  double dy = fmm->positions[j].y - fmm->positions[i].y;
+  double distance = sqrt(dx * dx + dy * dy);
+  if (distance == 0 || distance < min_distance) {
+    return;
+  }
+  double scale = 1 / (distance * distance * distance);
+  double mass_i = fmm->masses[i] * scale;
+  double mass_j = fmm->masses[j] * scale;
+  fmm->sorted_fields[i].x += mass_j * dx;
+  fmm->sorted_fields[i].y += mass_j * dy;
+  fmm->sorted_fields[j].x -= mass_i * dx;
+  fmm->sorted_fields[j].y -= mass_i * dy;
+}
+
+void fmm_push_pair(fmm_t *fmm, size_t *num_pairs, size_t node1, size_t node2) {
+  if (*num_pairs == fmm->pairs_capacity) {
+    fmm->pairs_capacity = fmm->pairs_capacity * 2 + 16;
+    fmm->pairs = realloc(fmm->pairs, sizeof(fmm_pair_t) * fmm->pairs_capacity);
+    assert(fmm->pairs != NULL);
+  }
+  fmm->pairs[(*num_pairs)++] = (fmm_pair_t){node1, node2};
+}
+
+// walks pairs of nodes from the root down, using expansions between pairs
+// that are far apart and summing pulls directly between leaves that aren't
+void fmm_interact(fmm_t *fmm, double min_distance) {
+  size_t num_pairs = 0;
+  fmm_push_pair(fmm, &num_pairs, 0, 0);
+  while (num_pairs > 0) {
+    fmm_pair_t pair = fmm->pairs[--num_pairs];
+    fmm_node_t node1 = fmm->nodes[pair.node1];
+    fmm_node_t node2 = fmm->nodes[pair.node2];
+
+    if (pair.node1 == pair.node2) {
+      if (node1.first_child == FMM_NO_CHILDREN) {
+        for (size_t i = node1.start; i < node1.end; i++) {
+          for (size_t j = i + 1; j < node1.end; j++) {
+            fmm_pull(fmm, i, j, min_distance);
+          }
+        }
+        continue;
+      }
+      for (size_t i = 0; i < 4; i++) {
+        size_t child1 = node1.first_child + i;
+        for (size_t j = i; j < 4 && !fmm_is_empty(fmm, child1); j++) {
+          size_t child2 = node1.first_child + j;
+          if (!fmm_is_empty(fmm, child2)) {
+            fmm_push_pair(fmm, &num_pairs, child1, child2);
+          }
+        }
+      }
+      continue;
+    }
+
+    vector_t offset = vec_subtract(node1.center, node2.center);
+    double distance = sqrt(vec_dot(offset, offset));
+    double radii = node1.radius + node2.radius;
+    // every pair of points must also be at least min_distance apart,
+    // since the expansions can't leave any of them out
+    if (radii < FMM_OPENING_ANGLE * distance &&
+        distance - radii >= min_distance) {
+      fmm_compute_derivatives(fmm, offset);
+      fmm_multipole_to_local(fmm, pair.node1, pair.node2, false);
+      fmm_multipole_to_local(fmm, pair.node2, pair.node1, true);
+      continue;
+    }
+
+    bool leaf1 = node1.first_child == FMM_NO_CHILDREN;
+    bool leaf2 = node2.first_child == FMM_NO_CHILDREN;
+    if (leaf1 && leaf2) {
+      for (size_t i = node1.start; i < node1.end; i++) {
+        for (size_t j = node2.start; j < node2.end; j++) {
+          fmm_pull(fmm, i, j, min_distance);
+        }
+      }
+      continue;
+    }
+    // split the bigger node
+    bool split1 = !leaf1 && (leaf2 || node1.radius >= node2.radius);
+    size_t split = split1 ? pair.node1 : pair.node2;
+    size_t other = split1 ? pair.node2 : pair.node1;
+    for (size_t i = 0; i < 4; i++) {
+      size_t child = fmm->nodes[split].first_child + i;
+      if (!fmm_is_empty(fmm, child)) {
+        fmm_push_pair(fmm, &num_pairs, child, other);
+      }
+    }
+  }
+}
+
+// passes each node's local expansion down to its children using
+// L'(d) = sum over g >= d of L(g) (g choose d) (c' - c)^(g - d),
+// then adds the gradient of each leaf's expansion to its points' fields
+void fmm_downward_pass(fmm_t *fmm) {
+  size_t order = fmm->order;
+  // parents always come before their children
+  for (size_t index = 0; index < fmm->num_nodes; index++) {
+    fmm_node_t *node = &fmm->nodes[index];
+    double *local = &fmm->locals[index * fmm->num_coefficients];
+    if (node->start == node->end) {
+      continue;
+    }
+    if (node->first_child == FMM_NO_CHILDREN) {
+      for (size_t i = node->start; i < node->end; i++) {
+        fmm_powers(fmm, vec_subtract(fmm->positions[i], node->center));
+        vector_t gradient = VEC_ZERO;
+        for (size_t n = 1; n <= order; n++) {
+          for (size_t b = 0; b <= n; b++) {
+            size_t a = n - b;
+            double coefficient = local[fmm_coefficient(a, b)];
+            if (a >= 1) {
+              gradient.x += a * coefficient * fmm->powers_x[a - 1] *
+                            fmm->powers_y[b];
+            }
+            if (b >= 1) {
+              gradient.y += b * coefficient * fmm->powers_x[a] *
+                            fmm->powers_y[b - 1];
+            }
+          }
+        }
+        fmm->sorted_fields[i] = vec_add(fmm->sorted_fields[i], gradient);
+      }
+      continue;
+    }
+    for (size_t c = 0; c < 4; c++) {
+      size_t child = node->first_child + c;
+      if (fmm_is_empty(fmm, child)) {
+        continue;
+      }
+      double *child_local = &fmm->locals[child * fmm->num_coefficients];
+      fmm_powers(fmm, vec_subtract(fmm->nodes[child].center, node->center));
+      for (size_t n = 0; n <= order; n++) {
+        for (size_t b = 0; b <= n; b++) {
+          size_t a = n - b;
+          double sum = 0;
+          for (size_t m = n; m <= order; m++) {
+            // i = m - j must be at least a
+            for (size_t j = b; j <= b + m - n; j++) {
+              size_t i = m - j;
+              sum += local[fmm_coefficient(i, j)] * fmm_binomial(fmm, i, a) *
+                     fmm_binomial(fmm, j, b) * fmm->powers_x[i - a] *
+                     fmm->powers_y[j - b];
+            }
+          }
+          child_local[fmm_coefficient(a, b)] += sum;
+        }
+      }
+    }
+  }
+}
+
+void fmm_solve(fmm_t *fmm, double min_distance) {
+  if (fmm->num_points == 0) {
+    return;
+  }
+  for (size_t i = 0; i < fmm->num_points; i++) {
+    fmm->sorted_fields[i] = VEC_ZERO;
+  }
+  fmm_build_tree(fmm);
+  fmm_upward_pass(fmm);
+  fmm_interact(fmm, min_distance);
+  fmm_downward_pass(fmm);
+  for (size_t i = 0; i < fmm->num_points; i++) {
+    fmm->fields[fmm->ids[i]] = fmm->sorted_fields[i];
+  }
+}
@@ -1,7 +1,10 @@
 #include "forces.h"
 #include "body.h"
 #include "collision.h"
+#include "fmm.h"
 #include "list.h"
+#include "pool.h"
+#include "quadtree.h"
 #include "vector.h"
 #include <math.h>
 #include <stdio.h>
@@ -10,31 +13,101 @@
 const double MIN_DISTANCE = 5.0;
 const double MARGIN = 0.5;
 
+// one of the bodies a force acts on. A body in the scene is kept as a handle,
+// so the force never touches it after it has been freed. A body outside the
+// scene, such as a fixed anchor, is never freed by the scene, so it is kept
+// as a pointer
+typedef struct aux_body {
+  body_handle_t handle;
+  // NULL if the body is in the scene
+  body_t *outside;
+} aux_body_t;
+
 typedef struct aux {
-  // two bodies on which the force will act
-  body_t *body1;
-  body_t *body2;
+  // the one or two bodies on which the force will act
+  scene_t *scene;
+  aux_body_t body1;
+  aux_body_t body2;
+  bool has_body2;
   // the constant of that force (could be gravity, spring, or drag)
   double force_constant;
+  // the scene's pool the aux was taken from, or NULL if it was malloc()ed
+  pool_t *pool;
 } aux_t;
 
+aux_body_t aux_body_init(scene_t *scene, body_t *body) {
+  if (scene_has_body(scene, body)) {
+    return (aux_body_t){.handle = scene_get_handle(scene, body),
+                        .outside = NULL};
+  }
+  return (aux_body_t){.outside = body};
+}
+
+// finds the body, or returns NULL if it was in the scene and has been freed
+body_t *aux_body_resolve(scene_t *scene, aux_body_t body) {
+  return body.outside != NULL ? body.outside
+                              : scene_resolve(scene, body.handle);
+}
+
 // aux constructor
 aux_t *aux_init(body_t *body1, body_t *body2, double constant) {
   aux_t *ret = malloc(sizeof(aux_t));
   assert(ret != NULL);
-  ret->body1 = body1;
-  ret->body2 = body2;
+  // without a scene, both bodies are kept as pointers
+  ret->scene = NULL;
+  ret->body1 = (aux_body_t){.outside = body1};
+  ret->has_body2 = body2 != NULL;
+  ret->body2 = (aux_body_t){.outside = body2};
+  ret->force_constant = constant;
+  ret->pool = NULL;
+  return ret;
+}
+
+aux_t *scene_aux_init(scene_t *scene, body_t *body1, body_t *body2,
+                      double constant) {
+  pool_t *pool = scene_aux_pool(scene);
+  assert(sizeof(aux_t) <= pool_object_size(pool));
+  aux_t *ret = pool_alloc(pool);
+  ret->scene = scene;
+  ret->body1 = aux_body_init(scene, body1);
+  ret->has_body2 = body2 != NULL;
+  if (body2 != NULL) {
+    ret->body2 = aux_body_init(scene, body2);
+  }
   ret->force_constant = constant;
+  ret->pool = pool;
   return ret;
 }
 
 // aux freer
-void free_aux(aux_t *aux) { free(aux); }
+void free_aux(aux_t *aux) {
+  if (aux->pool == NULL) {
+    free(aux);
+  } else {
+    pool_release(aux->pool, aux);
+  }
+}
+
+// finds the bodies an aux refers to, returning false if any has been freed
+bool aux_get_bodies(aux_t *aux, body_t **body1, body_t **body2) {
+  *body1 = aux_body_resolve(aux->scene, aux->body1);
+  if (*body1 == NULL) {
+    return false;
+  }
+  if (!aux->has_body2) {
+    *body2 = NULL;
+    return true;
+  }
+  *body2 = aux_body_resolve(aux->scene, aux->body2);
+  return *body2 != NULL;
+}
 
 void gravity(void *aux) {
   // unwrap data
-  body_t *body1 = (body_t *)(((aux_t *)aux)->body1);
-  body_t *body2 = (body_t *)(((aux_t *)aux)->body2);
+  body_t *body1, *body2;
+  if (!aux_get_bodies((aux_t *)aux, &body1, &body2)) {
+    return;
+  }
   double G = ((aux_t *)aux)->force_constant;
 
   // calculate gravity
@@ -57,22 +130,236 @@ void gravity(void *aux) {
 
 void create_newtonian_gravity(scene_t *scene, double gravity_constant,
                               body_t *body1, body_t *body2) {
-  // aux_t *aux =  aux_init(body1, body2, gravity_constant);
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->body1 = body1;
-  aux->body2 = body2;
-  aux->force_constant = gravity_constant;
+  aux_t *aux = scene_aux_init(scene, body1, body2, gravity_constant);
   list_t *bodies = list_init(2, NULL);
   list_add(bodies, body1);
   list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene, (force_creator_t)gravity, aux, bodies,
-                                 (free_func_t)free_aux);
+  scene_add_additive_force_creator(scene, (force_creator_t)gravity, aux, bodies,
+                                   (free_func_t)free_aux);
+}
+
+typedef struct barnes_hut_aux {
+  scene_t *scene;
+  double gravity_constant;
+  double theta;
+  // rebuilt every tick, but its memory is reused
+  quadtree_t *tree;
+} barnes_hut_aux_t;
+
+void free_barnes_hut_aux(barnes_hut_aux_t *aux) {
+  quadtree_free(aux->tree);
+  free(aux);
+}
+
+void barnes_hut_gravity(void *aux) {
+  barnes_hut_aux_t *data = (barnes_hut_aux_t *)aux;
+  scene_t *scene = data->scene;
+  quadtree_t *tree = data->tree;
+  size_t num_bodies = scene_bodies(scene);
+
+  quadtree_clear(tree);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    // infinitely heavy bodies are fixed anchors and don't take part
+    if (isfinite(mass)) {
+      quadtree_add_point(tree, body_get_centroid(body), mass);
+    }
+  }
+  quadtree_build(tree);
+
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if (!isfinite(mass)) {
+      continue;
+    }
+    vector_t field = quadtree_field(tree, body_get_centroid(body), data->theta,
+                                    MIN_DISTANCE);
+    body_add_force(body, vec_multiply(data->gravity_constant * mass, field));
+  }
+}
+
+void create_barnes_hut_gravity(scene_t *scene, double gravity_constant,
+                               double theta) {
+  assert(theta >= 0);
+  barnes_hut_aux_t *aux = malloc(sizeof(barnes_hut_aux_t));
+  assert(aux != NULL);
+  aux->scene = scene;
+  aux->gravity_constant = gravity_constant;
+  aux->theta = theta;
+  aux->tree = quadtree_init();
+  // acts on every body, so it isn't removed along with any one of them
+  list_t *bodies = list_init(0, NULL);
+  scene_add_bodies_force_creator(scene, (force_creator_t)barnes_hut_gravity,
+                                 aux, bodies,
+                                 (free_func_t)free_barnes_hut_aux);
+}
+
+typedef struct all_pairs_aux {
+  scene_t *scene;
+  double gravity_constant;
+  // the bodies still attracting each other, in the order they were given
+  aux_body_t *bodies;
+  size_t num_bodies;
+  // each body's position, mass and net force, gathered every tick
+  double *x;
+  double *y;
+  double *mass;
+  double *force_x;
+  double *force_y;
+} all_pairs_aux_t;
+
+void free_all_pairs_aux(all_pairs_aux_t *aux) {
+  free(aux->bodies);
+  // the other arrays share x's allocation
+  free(aux->x);
+  free(aux);
+}
+
+void all_pairs_gravity(void *aux) {
+  all_pairs_aux_t *data = (all_pairs_aux_t *)aux;
+  double G = data->gravity_constant;
+  double *x = data->x;
+  double *y = data->y;
+  double *mass = data->mass;
+  double *force_x = data->force_x;
+  double *force_y = data->force_y;
+
+  // drop the bodies that have been freed, keeping the rest in order, and
+  // gather the others into the arrays. A body marked with body_remove()
+  // still pulls until the scene frees it, as it would with gravity() on
+  // each pair, whose force creators are only removed along with the body
+  size_t num_bodies = 0;
+  for (size_t i = 0; i < data->num_bodies; i++) {
+    body_t *body = aux_body_resolve(data->scene, data->bodies[i]);
+    if (body == NULL) {
+      continue;
+    }
+    data->bodies[num_bodies] = data->bodies[i];
+    vector_t centroid = body_get_centroid(body);
+    vector_t force = body_get_force(body);
+    x[num_bodies] = centroid.x;
+    y[num_bodies] = centroid.y;
+    mass[num_bodies] = body_get_mass(body);
+    force_x[num_bodies] = force.x;
+    force_y[num_bodies] = force.y;
+    num_bodies++;
+  }
+  data->num_bodies = num_bodies;
+
+  // the same operations in the same order as gravity() on each pair,
+  // so the result is identical
+  for (size_t i = 0; i < num_bodies; i++) {
+    for (size_t j = i + 1; j < num_bodies; j++) {
+      double dx = x[j] - x[i];
+      double dy = y[j] - y[i];
+      double distance = sqrt(dx * dx + dy * dy);
+      if (distance < MIN_DISTANCE) {
+        continue;
+      }
+      double force = mass[i] * mass[j] * G / pow(distance, 2);
+      double scale = force / distance;
+      force_x[i] += dx * scale;
+      force_y[i] += dy * scale;
+      force_x[j] += -(dx * scale);
+      force_y[j] += -(dy * scale);
+    }
+  }
+
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_set_force(aux_body_resolve(data->scene, data->bodies[i]),
+                   (vector_t){force_x[i], force_y[i]});
+  }
+}
+
+void create_all_pairs_gravity(scene_t *scene, double gravity_constant,
+                              list_t *bodies) {
+  all_pairs_aux_t *aux = malloc(sizeof(all_pairs_aux_t));
+  assert(aux != NULL);
+  size_t num_bodies = list_size(bodies);
+  aux->scene = scene;
+  aux->gravity_constant = gravity_constant;
+  aux->bodies = malloc(sizeof(aux_body_t) * num_bodies);
+  aux->x = malloc(sizeof(double) * 5 * num_bodies);
+  assert(num_bodies == 0 || (aux->bodies != NULL && aux->x != NULL));
+  for (size_t i = 0; i < num_bodies; i++) {
+    aux->bodies[i] = aux_body_init(scene, list_get(bodies, i));
+  }
+  aux->num_bodies = num_bodies;
+  list_free(bodies);
+  aux->y = aux->x + num_bodies;
+  aux->mass = aux->y + num_bodies;
+  aux->force_x = aux->mass + num_bodies;
+  aux->force_y = aux->force_x + num_bodies;
+  // the bodies are kept by handle, so removing one of them only drops it,
+  // rather than removing the force along with it
+  scene_add_bodies_force_creator(scene, (force_creator_t)all_pairs_gravity,
+                                 aux, list_init(0, NULL),
+                                 (free_func_t)free_all_pairs_aux);
+}
+
+typedef struct fmm_aux {
+  scene_t *scene;
+  double gravity_constant;
+  // rebuilt every tick, but its memory is reused
+  fmm_t *fmm;
+} fmm_aux_t;
+
+void free_fmm_aux(fmm_aux_t *aux) {
+  fmm_free(aux->fmm);
+  free(aux);
+}
+
+void fmm_gravity(void *aux) {
+  fmm_aux_t *data = (fmm_aux_t *)aux;
+  scene_t *scene = data->scene;
+  fmm_t *fmm = data->fmm;
+  size_t num_bodies = scene_bodies(scene);
+
+  fmm_clear(fmm);
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    // infinitely heavy bodies are fixed anchors and don't take part
+    if (isfinite(mass)) {
+      fmm_add_point(fmm, body_get_centroid(body), mass);
+    }
+  }
+  fmm_solve(fmm, MIN_DISTANCE);
+
+  size_t index = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if (!isfinite(mass)) {
+      continue;
+    }
+    vector_t field = fmm_get_field(fmm, index);
+    index++;
+    body_add_force(body, vec_multiply(data->gravity_constant * mass, field));
+  }
+}
+
+void create_fmm_gravity(scene_t *scene, double gravity_constant,
+                        size_t order) {
+  fmm_aux_t *aux = malloc(sizeof(fmm_aux_t));
+  assert(aux != NULL);
+  aux->scene = scene;
+  aux->gravity_constant = gravity_constant;
+  aux->fmm = fmm_init(order);
+  // acts on every body, so it isn't removed along with any one of them
+  list_t *bodies = list_init(0, NULL);
+  scene_add_bodies_force_creator(scene, (force_creator_t)fmm_gravity, aux,
+                                 bodies, (free_func_t)free_fmm_aux);
 }
 
 void spring(void *aux) {
   // unwrap data
-  body_t *body1 = (body_t *)(((aux_t *)aux)->body1);
-  body_t *body2 = (body_t *)(((aux_t *)aux)->body2);
+  body_t *body1, *body2;
+  if (!aux_get_bodies((aux_t *)aux, &body1, &body2)) {
+    return;
+  }
   double K = ((aux_t *)aux)->force_constant;
 
   // calculate spring force
@@ -89,22 +376,21 @@ void spring(void *aux) {
 
 void create_spring(scene_t *scene, double spring_constant, body_t *body1,
                    body_t *body2) {
-  // aux_t *aux = aux_init(body1, body2, spring_constant);
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->body1 = body1;
-  aux->body2 = body2;
-  aux->force_constant = spring_constant;
+  aux_t *aux = scene_aux_init(scene, body1, body2, spring_constant);
   list_t *bodies = list_init(2, NULL);
   list_add(bodies, body1);
   list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene, (force_creator_t)spring, aux, bodies,
-                                 (free_func_t)free_aux);
+  scene_add_additive_force_creator(scene, (force_creator_t)spring, aux, bodies,
+                                   (free_func_t)free_aux);
 }
 
 void drag(void *aux) {
   // unwrap data
   aux_t *data = (aux_t *)aux;
-  body_t *body = (body_t *)data->body1;
+  body_t *body, *unused;
+  if (!aux_get_bodies(data, &body, &unused)) {
+    return;
+  }
   double D = data->force_constant;
 
   // calculate drag force
@@ -113,37 +399,28 @@ void drag(void *aux) {
 }
 
 void create_drag(scene_t *scene, double drag_constant, body_t *body) {
-  // aux_t *aux = aux_init(body, NULL, drag_constant);
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->body1 = body;
-  aux->body2 = NULL;
-  aux->force_constant = drag_constant;
+  aux_t *aux = scene_aux_init(scene, body, NULL, drag_constant);
   list_t *bodies = list_init(1, NULL);
   list_add(bodies, body);
-  scene_add_bodies_force_creator(scene, (force_creator_t)drag, aux, bodies,
-                                 (free_func_t)free_aux);
+  scene_add_additive_force_creator(scene, (force_creator_t)drag, aux, bodies,
+                                   (free_func_t)free_aux);
 }
 
 void collision(void *aux) {
-  list_t *shape_1 = body_get_shape((body_t *)(((aux_t *)aux)->body1));
-  list_t *shape_2 = body_get_shape((body_t *)(((aux_t *)aux)->body2));
-  if (find_collision(shape_1, shape_2)) {
+  body_t *body1, *body2;
+  if (!aux_get_bodies((aux_t *)aux, &body1, &body2)) {
+    return;
+  }
+  if (find_body_collision(body1, body2)) {
     // set bodies to be removed
-    body_remove((body_t *)(((aux_t *)aux)->body1));
-    body_remove((body_t *)(((aux_t *)aux)->body2));
+    body_remove(body1);
+    body_remove(body2);
   }
-  // have to free these lists cuz of the new list created when using
-  // body_get_shape()
-  list_free(shape_1);
-  list_free(shape_2);
 }
 
 void create_destructive_collision(scene_t *scene, body_t *body1,
                                   body_t *body2) {
-  aux_t *aux = malloc(sizeof(aux_t));
-  aux->body1 = body1;
-  aux->body2 = body2;
-  aux->force_constant = 0;
+  aux_t *aux = scene_aux_init(scene, body1, body2, 0);
   list_t *bodies = list_init(2, NULL);
   list_add(bodies, body1);
   list_add(bodies, body2);
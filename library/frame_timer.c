@@ -0,0 +1,106 @@
+#include "frame_timer.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+// the percentile reported as p99_seconds
+const size_t FRAME_TIMER_PERCENTILE = 99;
+
+typedef struct frame_timer {
+  // a ring buffer of the most recent frame times. Once it is full,
+  // next overwrites the oldest time
+  double *times;
+  size_t capacity;
+  size_t count;
+  size_t next;
+  // scratch space for sorting the times in frame_timer_stats()
+  double *sorted;
+  // when frame_timer_tick() was last called, if it has been
+  double last_tick;
+  bool has_ticked;
+} frame_timer_t;
+
+double frame_timer_now(void) {
+  struct timespec time;
+  int result = clock_gettime(CLOCK_MONOTONIC, &time);
+  assert(result == 0);
+  (void)result;
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+frame_timer_t *frame_timer_init(size_t history) {
+  assert(history > 0);
+  frame_timer_t *timer = malloc(sizeof(frame_timer_t));
+  assert(timer != NULL);
+  timer->times = malloc(sizeof(double) * history);
+  timer->sorted = malloc(sizeof(double) * history);
+  assert(timer->times != NULL && timer->sorted != NULL);
+  timer->capacity = history;
+  timer->count = 0;
+  timer->next = 0;
+  timer->last_tick = 0;
+  timer->has_ticked = false;
+  return timer;
+}
+
+void frame_timer_free(frame_timer_t *timer) {
+  free(timer->times);
+  free(timer->sorted);
+  free(timer);
+}
+
+double frame_timer_tick(frame_timer_t *timer) {
+  double now = frame_timer_now();
+  if (!timer->has_ticked) {
+    timer->last_tick = now;
+    timer->has_ticked = true;
+    return 0.0;
+  }
+  double seconds = now - timer->last_tick;
+  timer->last_tick = now;
+  frame_timer_record(timer, seconds);
+  return seconds;
+}
+
+void frame_timer_record(frame_timer_t *timer, double seconds) {
+  assert(seconds >= 0);
+  timer->times[timer->next] = seconds;
+  timer->next = (timer->next + 1) % timer->capacity;
+  if (timer->count < timer->capacity) {
+    timer->count++;
+  }
+}
+
+int frame_timer_compare_times(const void *a, const void *b) {
+  double time1 = *(const double *)a, time2 = *(const double *)b;
+  return (time1 > time2) - (time1 < time2);
+}
+
+frame_stats_t frame_timer_stats(frame_timer_t *timer) {
+  frame_stats_t stats = {.count = timer->count};
+  if (timer->count == 0) {
+    return stats;
+  }
+  // the order of a ring buffer's contents doesn't matter once they're sorted
+  double total = 0;
+  for (size_t i = 0; i < timer->count; i++) {
+    timer->sorted[i] = timer->times[i];
+    total += timer->times[i];
+  }
+  qsort(timer->sorted, timer->count, sizeof(double),
+        frame_timer_compare_times);
+  // the smallest time that at least 99% of the frames didn't exceed,
+  // rounding the rank up in integers so 0.99 * count can't round wrongly
+  size_t rank = (timer->count * FRAME_TIMER_PERCENTILE + 99) / 100;
+  stats.min_seconds = timer->sorted[0];
+  stats.avg_seconds = total / timer->count;
+  stats.p99_seconds = timer->sorted[rank - 1];
+  stats.max_seconds = timer->sorted[timer->count - 1];
+  return stats;
+}
+
+void frame_timer_clear(frame_timer_t *timer) {
+  timer->count = 0;
+  timer->next = 0;
+}
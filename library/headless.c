@@ -0,0 +1,96 @@
+#include "headless.h"
+#include "frame_timer.h"
+#include "list.h"
+#include "scene.h"
+#include "sdl_wrapper.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// the number of frame times kept for sdl_get_frame_stats()
+const size_t HEADLESS_FRAME_HISTORY = 100000;
+
+// the dt every frame simulates
+double headless_frame_time = 1.0 / 60;
+// measures how long each frame really took, between calls to
+// time_since_last_tick() as sdl_wrapper.c does, or NULL until the first call
+frame_timer_t *headless_timer = NULL;
+// the scenes created since headless_watch_scenes() that haven't been freed,
+// or NULL before it is called
+list_t *headless_scenes = NULL;
+// the work done by the watched scenes that have been freed
+scene_tick_totals_t headless_freed_totals = {.ticks = 0, .body_updates = 0};
+
+void headless_set_frame_time(double seconds) {
+  assert(seconds >= 0);
+  headless_frame_time = seconds;
+}
+
+void sdl_init(vector_t min, vector_t max) {
+  assert(min.x < max.x);
+  assert(min.y < max.y);
+}
+
+bool sdl_is_done(state_t *state) { return false; }
+
+void sdl_clear(void) {}
+
+void sdl_draw_polygon(list_t *points, rgb_color_t color) {}
+
+void sdl_draw_shape(polygon_t *shape, rgb_color_t color) {}
+
+void sdl_show(void) {}
+
+void sdl_render_scene(scene_t *scene) {}
+
+void sdl_on_key(key_handler_t handler) {}
+
+double time_since_last_tick(void) {
+  if (headless_timer == NULL) {
+    headless_timer = frame_timer_init(HEADLESS_FRAME_HISTORY);
+  }
+  frame_timer_tick(headless_timer);
+  return headless_frame_time;
+}
+
+frame_stats_t sdl_get_frame_stats(void) {
+  if (headless_timer == NULL) {
+    return (frame_stats_t){.count = 0};
+  }
+  return frame_timer_stats(headless_timer);
+}
+
+void headless_add_scene(scene_t *scene) { list_add(headless_scenes, scene); }
+
+// keeps a freed scene's work in the totals
+void headless_remove_scene(scene_t *scene) {
+  for (size_t i = 0; i < list_size(headless_scenes); i++) {
+    if (list_get(headless_scenes, i) == scene) {
+      scene_tick_totals_t totals = scene_get_tick_totals(scene);
+      headless_freed_totals.ticks += totals.ticks;
+      headless_freed_totals.body_updates += totals.body_updates;
+      list_remove(headless_scenes, i);
+      return;
+    }
+  }
+}
+
+void headless_watch_scenes(void) {
+  if (headless_scenes == NULL) {
+    headless_scenes = list_init(4, NULL);
+  }
+  scene_set_hooks(headless_add_scene, headless_remove_scene);
+}
+
+scene_tick_totals_t headless_get_tick_totals(void) {
+  scene_tick_totals_t totals = headless_freed_totals;
+  if (headless_scenes == NULL) {
+    return totals;
+  }
+  for (size_t i = 0; i < list_size(headless_scenes); i++) {
+    scene_tick_totals_t scene_totals =
+        scene_get_tick_totals(list_get(headless_scenes, i));
+    totals.ticks += scene_totals.ticks;
+    totals.body_updates += scene_totals.body_updates;
+  }
+  return totals;
+}
@@ -0,0 +1,215 @@
+#include "kinematics.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the widest vector instructions the compiler was told it may use.
+// Doubles only need AVX (AVX2 adds integer instructions), so -mavx2 and
+// -march=native both pick the 4-lane path. Every x86-64 target has SSE2;
+// other targets, like WebAssembly, fall back to the scalar loop
+#if defined(__AVX__)
+#include <immintrin.h>
+#define KINEMATICS_LANES 4
+typedef __m256d lanes_t;
+#define lanes_load _mm256_loadu_pd
+#define lanes_store _mm256_storeu_pd
+#define lanes_set1 _mm256_set1_pd
+#define lanes_add _mm256_add_pd
+#define lanes_mul _mm256_mul_pd
+#define lanes_div _mm256_div_pd
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define KINEMATICS_LANES 2
+typedef __m128d lanes_t;
+#define lanes_load _mm_loadu_pd
+#define lanes_store _mm_storeu_pd
+#define lanes_set1 _mm_set1_pd
+#define lanes_add _mm_add_pd
+#define lanes_mul _mm_mul_pd
+#define lanes_div _mm_div_pd
+#else
+#define KINEMATICS_LANES 1
+#endif
+
+// the number of double arrays in a store, which share one allocation
+#define KINEMATICS_ARRAYS 12
+
+// points each array at its part of one allocation for capacity entries
+void kinematics_set_arrays(kinematics_t *kinematics, double *memory,
+                           size_t capacity) {
+  double **arrays[KINEMATICS_ARRAYS] = {
+      &kinematics->mass,           &kinematics->inverse_mass,
+      &kinematics->x,              &kinematics->y,
+      &kinematics->velocity_x,     &kinematics->velocity_y,
+      &kinematics->old_velocity_x, &kinematics->old_velocity_y,
+      &kinematics->orientation,    &kinematics->angular_velocity,
+      &kinematics->force_x,        &kinematics->force_y};
+  for (size_t i = 0; i < KINEMATICS_ARRAYS; i++) {
+    *arrays[i] = memory + i * capacity;
+  }
+}
+
+void kinematics_reserve(kinematics_t *kinematics, size_t capacity) {
+  double *memory = malloc(sizeof(double) * KINEMATICS_ARRAYS * capacity);
+  assert(memory != NULL);
+  // the old arrays all start at kinematics->mass
+  double *old_memory = kinematics->mass;
+  size_t old_capacity = kinematics->capacity;
+  for (size_t i = 0; i < KINEMATICS_ARRAYS && kinematics->size > 0; i++) {
+    memcpy(memory + i * capacity, old_memory + i * old_capacity,
+           sizeof(double) * kinematics->size);
+  }
+  free(old_memory);
+  kinematics_set_arrays(kinematics, memory, capacity);
+  kinematics->bodies =
+      realloc(kinematics->bodies, sizeof(body_t *) * capacity);
+  assert(kinematics->bodies != NULL);
+  kinematics->capacity = capacity;
+}
+
+kinematics_t *kinematics_init(size_t capacity) {
+  kinematics_t *kinematics = malloc(sizeof(kinematics_t));
+  assert(kinematics != NULL);
+  kinematics->size = 0;
+  kinematics->capacity = 0;
+  kinematics->mass = NULL;
+  kinematics->bodies = NULL;
+  kinematics_reserve(kinematics, capacity > 0 ? capacity : 1);
+  return kinematics;
+}
+
+void kinematics_free(kinematics_t *kinematics) {
+  free(kinematics->mass);
+  free(kinematics->bodies);
+  free(kinematics);
+}
+
+size_t kinematics_add(kinematics_t *kinematics, body_t *body) {
+  if (kinematics->size == kinematics->capacity) {
+    kinematics_reserve(kinematics, kinematics->capacity * 2);
+  }
+  size_t index = kinematics->size++;
+  kinematics->bodies[index] = body;
+  return index;
+}
+
+body_t *kinematics_remove(kinematics_t *kinematics, size_t index) {
+  assert(index < kinematics->size);
+  size_t last = --kinematics->size;
+  if (index == last) {
+    return NULL;
+  }
+  double *memory = kinematics->mass;
+  for (size_t i = 0; i < KINEMATICS_ARRAYS; i++) {
+    double *array = memory + i * kinematics->capacity;
+    array[index] = array[last];
+  }
+  kinematics->bodies[index] = kinematics->bodies[last];
+  return kinematics->bodies[index];
+}
+
+// the scalar loop of kinematics_integrate(). restrict tells the compiler the arrays
+// don't overlap, so it can vectorize the loop; gcc only trusts restrict on
+// parameters, not on locals copied out of a struct
+void kinematics_integrate_arrays(
+    size_t size, double dt, double *restrict mass, double *restrict x,
+    double *restrict y, double *restrict velocity_x,
+    double *restrict velocity_y, double *restrict old_velocity_x,
+    double *restrict old_velocity_y, double *restrict orientation,
+    double *restrict angular_velocity, double *restrict force_x,
+    double *restrict force_y) {
+  double half_dt = dt / 2;
+  // the same arithmetic as body_tick(), so both give identical results
+  for (size_t i = 0; i < size; i++) {
+    double scale = dt / mass[i];
+    double new_velocity_x = velocity_x[i] + scale * force_x[i];
+    double new_velocity_y = velocity_y[i] + scale * force_y[i];
+    x[i] += half_dt * (new_velocity_x + old_velocity_x[i]);
+    y[i] += half_dt * (new_velocity_y + old_velocity_y[i]);
+    orientation[i] += angular_velocity[i];
+    velocity_x[i] = new_velocity_x;
+    velocity_y[i] = new_velocity_y;
+    old_velocity_x[i] = new_velocity_x;
+    old_velocity_y[i] = new_velocity_y;
+    force_x[i] = 0;
+    force_y[i] = 0;
+  }
+}
+
+#if KINEMATICS_LANES > 1
+// integrates entries [0, size) a vector of entries at a time, returning how
+// many it did. It does the same divisions, multiplications and additions in
+// the same order as the scalar loop, so each lane rounds identically
+size_t kinematics_integrate_lanes(
+    size_t size, double dt, double *restrict mass, double *restrict x,
+    double *restrict y, double *restrict velocity_x,
+    double *restrict velocity_y, double *restrict old_velocity_x,
+    double *restrict old_velocity_y, double *restrict orientation,
+    double *restrict angular_velocity, double *restrict force_x,
+    double *restrict force_y) {
+  lanes_t dts = lanes_set1(dt);
+  lanes_t half_dts = lanes_set1(dt / 2);
+  lanes_t zero = lanes_set1(0);
+  size_t i = 0;
+  for (; i + KINEMATICS_LANES <= size; i += KINEMATICS_LANES) {
+    lanes_t scale = lanes_div(dts, lanes_load(&mass[i]));
+    lanes_t new_velocity_x = lanes_add(
+        lanes_load(&velocity_x[i]), lanes_mul(scale, lanes_load(&force_x[i])));
+    lanes_t new_velocity_y = lanes_add(
+        lanes_load(&velocity_y[i]), lanes_mul(scale, lanes_load(&force_y[i])));
+    lanes_t step_x = lanes_mul(
+        half_dts, lanes_add(new_velocity_x, lanes_load(&old_velocity_x[i])));
+    lanes_t step_y = lanes_mul(
+        half_dts, lanes_add(new_velocity_y, lanes_load(&old_velocity_y[i])));
+    lanes_store(&x[i], lanes_add(lanes_load(&x[i]), step_x));
+    lanes_store(&y[i], lanes_add(lanes_load(&y[i]), step_y));
+    lanes_store(&orientation[i], lanes_add(lanes_load(&orientation[i]),
+                                           lanes_load(&angular_velocity[i])));
+    lanes_store(&velocity_x[i], new_velocity_x);
+    lanes_store(&velocity_y[i], new_velocity_y);
+    lanes_store(&old_velocity_x[i], new_velocity_x);
+    lanes_store(&old_velocity_y[i], new_velocity_y);
+    lanes_store(&force_x[i], zero);
+    lanes_store(&force_y[i], zero);
+  }
+  return i;
+}
+#endif
+
+size_t kinematics_lanes(void) { return KINEMATICS_LANES; }
+
+void kinematics_integrate_scalar(kinematics_t *kinematics, double dt) {
+  kinematics_integrate_arrays(
+      kinematics->size, dt, kinematics->mass, kinematics->x, kinematics->y,
+      kinematics->velocity_x, kinematics->velocity_y,
+      kinematics->old_velocity_x, kinematics->old_velocity_y,
+      kinematics->orientation, kinematics->angular_velocity,
+      kinematics->force_x, kinematics->force_y);
+}
+
+void kinematics_integrate_range(kinematics_t *kinematics, double dt,
+                                size_t start, size_t end) {
+  assert(start <= end && end <= kinematics->size);
+  size_t done = start;
+#if KINEMATICS_LANES > 1
+  done += kinematics_integrate_lanes(
+      end - start, dt, kinematics->mass + start, kinematics->x + start,
+      kinematics->y + start, kinematics->velocity_x + start,
+      kinematics->velocity_y + start, kinematics->old_velocity_x + start,
+      kinematics->old_velocity_y + start, kinematics->orientation + start,
+      kinematics->angular_velocity + start, kinematics->force_x + start,
+      kinematics->force_y + start);
+#endif
+  // the entries left over after the last full vector
+  kinematics_integrate_arrays(
+      end - done, dt, kinematics->mass + done, kinematics->x + done,
+      kinematics->y + done, kinematics->velocity_x + done,
+      kinematics->velocity_y + done, kinematics->old_velocity_x + done,
+      kinematics->old_velocity_y + done, kinematics->orientation + done,
+      kinematics->angular_velocity + done, kinematics->force_x + done,
+      kinematics->force_y + done);
+}
+
+void kinematics_integrate(kinematics_t *kinematics, double dt) {
+  kinematics_integrate_range(kinematics, dt, 0, kinematics->size);
+}
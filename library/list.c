@@ -4,6 +4,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 const size_t RESIZE_MULTIPLE = 2;
 
@@ -48,10 +49,31 @@ void *list_get(list_t *list, size_t index) {
   return list->vd[index];
 }
 
+// changes the number of elements the list has room for
+void set_capacity(list_t *list, size_t capacity) {
+  list->vd = realloc(list->vd, sizeof(void *) * capacity);
+  assert(list->vd != NULL);
+  list->capacity = capacity;
+}
+
 void resize(list_t *list) {
-  size_t new_capacity = 100 + list->capacity * RESIZE_MULTIPLE;
-  list->vd = realloc(list->vd, sizeof(void *) * new_capacity * 2);
-  list->capacity = new_capacity;
+  // growing geometrically makes appending amortized O(1)
+  set_capacity(list, list->capacity * RESIZE_MULTIPLE);
+}
+
+void list_reserve(list_t *list, size_t capacity) {
+  if (capacity > list->capacity) {
+    set_capacity(list, capacity);
+  }
+}
+
+void list_clear(list_t *list) {
+  if (list->freer != NULL) {
+    for (size_t i = 0; i < list->size; i++) {
+      list->freer(list->vd[i]);
+    }
+  }
+  list->size = 0;
 }
 
 void list_add(list_t *list, void *value) {
@@ -66,9 +88,8 @@ void list_add(list_t *list, void *value) {
 }
 
 void remover_helper(list_t *list, size_t index) {
-  for (size_t i = index; i < list->size - 1; i++) {
-    list->vd[i] = list_get(list, i + 1);
-  }
+  memmove(&list->vd[index], &list->vd[index + 1],
+          sizeof(void *) * (list->size - index - 1));
   list->vd[list->size - 1] = NULL;
 }
 
@@ -80,4 +101,29 @@ void *list_remove(list_t *list, size_t index) {
   remover_helper(list, index);
   list->size--;
   return ret;
-}
\ No newline at end of file
+}
+void *list_swap_remove(list_t *list, size_t index) {
+  assert(index < list->size);
+  void *ret = list->vd[index];
+  list->size--;
+  list->vd[index] = list->vd[list->size];
+  list->vd[list->size] = NULL;
+  return ret;
+}
+
+size_t list_remove_if(list_t *list, list_predicate_t predicate, void *aux,
+                      bool free_removed) {
+  size_t kept = 0;
+  for (size_t i = 0; i < list->size; i++) {
+    void *element = list->vd[i];
+    if (!predicate(element, aux)) {
+      list->vd[kept] = element;
+      kept++;
+    } else if (free_removed && list->freer != NULL) {
+      list->freer(element);
+    }
+  }
+  size_t removed = list->size - kept;
+  list->size = kept;
+  return removed;
+}
@@ -1,6 +1,8 @@
 #include "polygon.h"
+#include "arena.h"
 #include "list.h"
 #include "vector.h"
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -45,12 +47,188 @@ void polygon_translate(list_t *polygon, vector_t translation) {
 }
 
 void polygon_rotate(list_t *polygon, double angle, vector_t point) {
+  // one sin and cos for the whole polygon instead of one per vertex
+  polygon_rotate_by(polygon, rotation_from_angle(angle), point);
+}
+
+void polygon_rotate_by(list_t *polygon, rotation_t rotation, vector_t point) {
   size_t size = list_size(polygon);
   for (size_t i = 0; i < size; i++) {
     vector_t *temp = list_get(polygon, i);
     vector_t relative_to_point = vec_subtract((vector_t)(*temp), point);
-    vector_t rotated = vec_rotate(relative_to_point, angle);
+    vector_t rotated = vec_rotate_by(relative_to_point, rotation);
     vector_t ret = vec_add(rotated, point);
     *(vector_t *)list_get(polygon, i) = ret;
   }
-}
\ No newline at end of file
+}
+
+bounding_box_t polygon_bounding_box(list_t *polygon) {
+  vector_t first = *(vector_t *)list_get(polygon, 0);
+  bounding_box_t box = {.min = first, .max = first};
+  size_t size = list_size(polygon);
+  for (size_t i = 1; i < size; i++) {
+    vector_t point = *(vector_t *)list_get(polygon, i);
+    box.min.x = fmin(box.min.x, point.x);
+    box.min.y = fmin(box.min.y, point.y);
+    box.max.x = fmax(box.max.x, point.x);
+    box.max.y = fmax(box.max.y, point.y);
+  }
+  return box;
+}
+
+polygon_t *polygon_init(size_t size) {
+  polygon_t *polygon = malloc(sizeof(polygon_t));
+  assert(polygon != NULL);
+  polygon->size = size;
+  // both coordinate arrays share one allocation
+  polygon->x = malloc(sizeof(double) * 2 * size);
+  assert(size == 0 || polygon->x != NULL);
+  polygon->y = polygon->x + size;
+  return polygon;
+}
+
+polygon_t *polygon_from_list(list_t *vertices) {
+  size_t size = list_size(vertices);
+  polygon_t *polygon = polygon_init(size);
+  for (size_t i = 0; i < size; i++) {
+    vector_t vertex = *(vector_t *)list_get(vertices, i);
+    polygon->x[i] = vertex.x;
+    polygon->y[i] = vertex.y;
+  }
+  return polygon;
+}
+
+list_t *polygon_to_list(polygon_t *polygon) {
+  list_t *vertices = list_init(polygon->size, free);
+  for (size_t i = 0; i < polygon->size; i++) {
+    vector_t *vertex = malloc(sizeof(vector_t));
+    assert(vertex != NULL);
+    *vertex = (vector_t){polygon->x[i], polygon->y[i]};
+    list_add(vertices, vertex);
+  }
+  return vertices;
+}
+
+polygon_t *polygon_copy(polygon_t *polygon) {
+  polygon_t *copy = polygon_init(polygon->size);
+  for (size_t i = 0; i < polygon->size; i++) {
+    copy->x[i] = polygon->x[i];
+    copy->y[i] = polygon->y[i];
+  }
+  return copy;
+}
+
+polygon_t *polygon_init_in_arena(arena_t *arena, size_t size) {
+  polygon_t *polygon = arena_alloc(arena, sizeof(polygon_t));
+  polygon->size = size;
+  polygon->x = arena_alloc(arena, sizeof(double) * 2 * size);
+  polygon->y = polygon->x + size;
+  return polygon;
+}
+
+polygon_t *polygon_copy_in_arena(polygon_t *polygon, arena_t *arena) {
+  polygon_t *copy = polygon_init_in_arena(arena, polygon->size);
+  for (size_t i = 0; i < polygon->size; i++) {
+    copy->x[i] = polygon->x[i];
+    copy->y[i] = polygon->y[i];
+  }
+  return copy;
+}
+
+void polygon_free(polygon_t *polygon) {
+  free(polygon->x);
+  free(polygon);
+}
+
+vector_t polygon_get_vertex(polygon_t *polygon, size_t index) {
+  assert(index < polygon->size);
+  return (vector_t){polygon->x[index], polygon->y[index]};
+}
+
+double polygon_compute_area(polygon_t *polygon) {
+  double *x = polygon->x;
+  double *y = polygon->y;
+  size_t size = polygon->size;
+  double area = 0;
+  // trapezoid formula, with the edge from the last vertex to the first
+  // handled outside the loop to avoid a modulo per vertex
+  for (size_t i = 0; i + 1 < size; i++) {
+    area += (y[i] + y[i + 1]) * (x[i] - x[i + 1]);
+  }
+  if (size > 0) {
+    area += (y[size - 1] + y[0]) * (x[size - 1] - x[0]);
+  }
+  return area / 2;
+}
+
+vector_t polygon_compute_centroid(polygon_t *polygon) {
+  double *x = polygon->x;
+  double *y = polygon->y;
+  size_t size = polygon->size;
+  double area = polygon_compute_area(polygon);
+  // a degenerate polygon has no centroid
+  assert(area != 0);
+  vector_t centroid = (vector_t){.x = 0.0, .y = 0.0};
+  for (size_t i = 0; i < size; i++) {
+    size_t next = i + 1 == size ? 0 : i + 1;
+    double cross = x[i] * y[next] - y[i] * x[next];
+    centroid.x += (x[i] + x[next]) * cross;
+    centroid.y += (y[i] + y[next]) * cross;
+  }
+  return vec_multiply(1 / (6 * area), centroid);
+}
+
+void polygon_apply_translation(polygon_t *polygon, vector_t translation) {
+  for (size_t i = 0; i < polygon->size; i++) {
+    polygon->x[i] += translation.x;
+    polygon->y[i] += translation.y;
+  }
+}
+
+void polygon_apply_rotation(polygon_t *polygon, double angle, vector_t point) {
+  // one sin and cos for the whole polygon instead of one per vertex
+  polygon_apply_rotation_by(polygon, rotation_from_angle(angle), point);
+}
+
+void polygon_apply_rotation_by(polygon_t *polygon, rotation_t rotation,
+                               vector_t point) {
+  double cos_angle = rotation.cos_angle;
+  double sin_angle = rotation.sin_angle;
+  for (size_t i = 0; i < polygon->size; i++) {
+    double dx = polygon->x[i] - point.x;
+    double dy = polygon->y[i] - point.y;
+    polygon->x[i] = cos_angle * dx - sin_angle * dy + point.x;
+    polygon->y[i] = sin_angle * dx + cos_angle * dy + point.y;
+  }
+}
+
+void polygon_transform_into(polygon_t *polygon, double angle,
+                            vector_t translation, polygon_t *out) {
+  polygon_transform_by(polygon, rotation_from_angle(angle), translation, out);
+}
+
+void polygon_transform_by(polygon_t *polygon, rotation_t rotation,
+                          vector_t translation, polygon_t *out) {
+  assert(out->size == polygon->size);
+  double cos_angle = rotation.cos_angle;
+  double sin_angle = rotation.sin_angle;
+  for (size_t i = 0; i < polygon->size; i++) {
+    double x = polygon->x[i];
+    double y = polygon->y[i];
+    out->x[i] = cos_angle * x - sin_angle * y + translation.x;
+    out->y[i] = sin_angle * x + cos_angle * y + translation.y;
+  }
+}
+
+bounding_box_t polygon_compute_bounding_box(polygon_t *polygon) {
+  assert(polygon->size > 0);
+  bounding_box_t box = {.min = {polygon->x[0], polygon->y[0]},
+                        .max = {polygon->x[0], polygon->y[0]}};
+  for (size_t i = 1; i < polygon->size; i++) {
+    box.min.x = fmin(box.min.x, polygon->x[i]);
+    box.min.y = fmin(box.min.y, polygon->y[i]);
+    box.max.x = fmax(box.max.x, polygon->x[i]);
+    box.max.y = fmax(box.max.y, polygon->y[i]);
+  }
+  return box;
+}
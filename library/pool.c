@@ -0,0 +1,105 @@
+#include "pool.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// how many objects each slab holds
+const size_t POOL_SLAB_OBJECTS = 64;
+
+// the start of each slab, which links the pool's slabs together.
+// The union keeps the objects after it aligned for any type
+typedef union pool_slab {
+  union pool_slab *next;
+  max_align_t alignment;
+} pool_slab_t;
+
+typedef struct pool {
+  size_t object_size;
+  // object_size rounded up so every object in a slab is aligned
+  // and can hold a free list link
+  size_t stride;
+  pool_slab_t *slabs;
+  // released objects, each storing a pointer to the next
+  void *free_list;
+  size_t live;
+} pool_t;
+
+pool_t *pool_init(size_t object_size) {
+  assert(object_size > 0);
+  pool_t *pool = malloc(sizeof(pool_t));
+  assert(pool != NULL);
+  size_t align = alignof(max_align_t);
+  pool->object_size = object_size;
+  pool->stride = (object_size + align - 1) / align * align;
+  pool->slabs = NULL;
+  pool->free_list = NULL;
+  pool->live = 0;
+  return pool;
+}
+
+void pool_free(pool_t *pool) {
+  pool_slab_t *slab = pool->slabs;
+  while (slab != NULL) {
+    pool_slab_t *next = slab->next;
+    free(slab);
+    slab = next;
+  }
+  free(pool);
+}
+
+size_t pool_object_size(pool_t *pool) { return pool->object_size; }
+
+size_t pool_live(pool_t *pool) { return pool->live; }
+
+#ifdef POOL_USE_MALLOC
+
+void *pool_alloc(pool_t *pool) {
+  void *object = malloc(pool->object_size);
+  assert(object != NULL);
+  pool->live++;
+  return object;
+}
+
+void pool_release(pool_t *pool, void *object) {
+  assert(pool->live > 0);
+  free(object);
+  pool->live--;
+}
+
+#else
+
+// allocates a slab and puts all its objects on the free list
+void pool_add_slab(pool_t *pool) {
+  pool_slab_t *slab =
+      malloc(sizeof(pool_slab_t) + pool->stride * POOL_SLAB_OBJECTS);
+  assert(slab != NULL);
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  char *objects = (char *)(slab + 1);
+  // link them in reverse so objects are handed out in address order
+  for (size_t i = POOL_SLAB_OBJECTS; i > 0; i--) {
+    void *object = objects + (i - 1) * pool->stride;
+    *(void **)object = pool->free_list;
+    pool->free_list = object;
+  }
+}
+
+void *pool_alloc(pool_t *pool) {
+  if (pool->free_list == NULL) {
+    pool_add_slab(pool);
+  }
+  void *object = pool->free_list;
+  pool->free_list = *(void **)object;
+  pool->live++;
+  return object;
+}
+
+void pool_release(pool_t *pool, void *object) {
+  assert(pool->live > 0);
+  *(void **)object = pool->free_list;
+  pool->free_list = object;
+  pool->live--;
+}
+
+#endif // #ifdef POOL_USE_MALLOC
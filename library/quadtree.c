@@ -0,0 +1,263 @@
+#include "quadtree.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// leaves hold up to this many points, which are summed directly
+const size_t QUAD_LEAF_CAPACITY = 8;
+// stops splitting points that are at (almost) the same position
+#define QUAD_MAX_DEPTH 40
+// a traversal leaves at most 3 unvisited siblings on the stack per level,
+// so this bounds the stack size
+#define QUAD_STACK_SIZE (3 * QUAD_MAX_DEPTH + 4)
+// marks a leaf's first_child
+const size_t QUAD_NO_CHILDREN = SIZE_MAX;
+
+typedef struct quadtree_node {
+  // the center and half the side length of the node's square
+  vector_t center;
+  double half_size;
+  double mass;
+  vector_t center_of_mass;
+  // the node's points are positions[start] to positions[end - 1]
+  size_t start;
+  size_t end;
+  // the index of the first of the node's 4 consecutive children
+  size_t first_child;
+} quadtree_node_t;
+
+typedef struct quadtree {
+  // the points, reordered by quadtree_build() so each node's are contiguous
+  vector_t *positions;
+  double *masses;
+  size_t num_points;
+  size_t points_capacity;
+  // nodes[0] is the root
+  quadtree_node_t *nodes;
+  size_t num_nodes;
+  size_t nodes_capacity;
+} quadtree_t;
+
+quadtree_t *quadtree_init(void) {
+  quadtree_t *tree = malloc(sizeof(quadtree_t));
+  assert(tree != NULL);
+  tree->positions = NULL;
+  tree->masses = NULL;
+  tree->num_points = 0;
+  tree->points_capacity = 0;
+  tree->nodes = NULL;
+  tree->num_nodes = 0;
+  tree->nodes_capacity = 0;
+  return tree;
+}
+
+void quadtree_free(quadtree_t *tree) {
+  free(tree->positions);
+  free(tree->masses);
+  free(tree->nodes);
+  free(tree);
+}
+
+void quadtree_clear(quadtree_t *tree) {
+  tree->num_points = 0;
+  tree->num_nodes = 0;
+}
+
+void quadtree_add_point(quadtree_t *tree, vector_t position, double mass) {
+  assert(isfinite(mass) && mass >= 0);
+  if (tree->num_points == tree->points_capacity) {
+    size_t capacity =
+        tree->points_capacity == 0 ? 16 : tree->points_capacity * 2;
+    tree->positions = realloc(tree->positions, sizeof(vector_t) * capacity);
+    tree->masses = realloc(tree->masses, sizeof(double) * capacity);
+    assert(tree->positions != NULL);
+    assert(tree->masses != NULL);
+    tree->points_capacity = capacity;
+  }
+  tree->positions[tree->num_points] = position;
+  tree->masses[tree->num_points] = mass;
+  tree->num_points++;
+}
+
+size_t quadtree_size(quadtree_t *tree) { return tree->num_points; }
+
+// adds 4 children to the end of the node array, returning the first
+size_t quad_allocate_children(quadtree_t *tree) {
+  if (tree->num_nodes + 4 > tree->nodes_capacity) {
+    size_t capacity = tree->nodes_capacity * 2 + 4;
+    tree->nodes = realloc(tree->nodes, sizeof(quadtree_node_t) * capacity);
+    assert(tree->nodes != NULL);
+    tree->nodes_capacity = capacity;
+  }
+  size_t first = tree->num_nodes;
+  tree->num_nodes += 4;
+  return first;
+}
+
+void quad_swap_points(quadtree_t *tree, size_t i, size_t j) {
+  vector_t position = tree->positions[i];
+  tree->positions[i] = tree->positions[j];
+  tree->positions[j] = position;
+  double mass = tree->masses[i];
+  tree->masses[i] = tree->masses[j];
+  tree->masses[j] = mass;
+}
+
+// moves the points in [start, end) whose coordinate is below split to the
+// front of the range, returning the index of the first point that isn't
+size_t quad_partition(quadtree_t *tree, size_t start, size_t end, bool use_x,
+                      double split) {
+  size_t middle = start;
+  for (size_t i = start; i < end; i++) {
+    vector_t position = tree->positions[i];
+    if ((use_x ? position.x : position.y) < split) {
+      quad_swap_points(tree, i, middle);
+      middle++;
+    }
+  }
+  return middle;
+}
+
+void quad_build_node(quadtree_t *tree, size_t index, size_t depth) {
+  quadtree_node_t node = tree->nodes[index];
+  size_t count = node.end - node.start;
+  if (count <= QUAD_LEAF_CAPACITY || depth >= QUAD_MAX_DEPTH) {
+    node.first_child = QUAD_NO_CHILDREN;
+    node.mass = 0;
+    node.center_of_mass = VEC_ZERO;
+    for (size_t i = node.start; i < node.end; i++) {
+      node.mass += tree->masses[i];
+      node.center_of_mass =
+          vec_add(node.center_of_mass,
+                  vec_multiply(tree->masses[i], tree->positions[i]));
+    }
+  } else {
+    // split by y, then split each half by x:
+    // children are ordered bottom left, bottom right, top left, top right
+    size_t bottom_end =
+        quad_partition(tree, node.start, node.end, false, node.center.y);
+    size_t bounds[5] = {
+        node.start,
+        quad_partition(tree, node.start, bottom_end, true, node.center.x),
+        bottom_end,
+        quad_partition(tree, bottom_end, node.end, true, node.center.x),
+        node.end};
+    node.first_child = quad_allocate_children(tree);
+    double quarter = node.half_size / 2;
+    node.mass = 0;
+    node.center_of_mass = VEC_ZERO;
+    for (size_t i = 0; i < 4; i++) {
+      size_t child = node.first_child + i;
+      tree->nodes[child] = (quadtree_node_t){
+          .center = {node.center.x + (i % 2 == 0 ? -quarter : quarter),
+                     node.center.y + (i < 2 ? -quarter : quarter)},
+          .half_size = quarter,
+          .start = bounds[i],
+          .end = bounds[i + 1]};
+      if (bounds[i] == bounds[i + 1]) {
+        tree->nodes[child].mass = 0;
+        tree->nodes[child].first_child = QUAD_NO_CHILDREN;
+        continue;
+      }
+      // building the child can move the node array
+      quad_build_node(tree, child, depth + 1);
+      quadtree_node_t built = tree->nodes[child];
+      node.mass += built.mass;
+      node.center_of_mass =
+          vec_add(node.center_of_mass,
+                  vec_multiply(built.mass, built.center_of_mass));
+    }
+  }
+  // the sums above are weighted by mass; massless nodes pull on nothing
+  node.center_of_mass = node.mass > 0
+                            ? vec_multiply(1 / node.mass, node.center_of_mass)
+                            : node.center;
+  tree->nodes[index] = node;
+}
+
+void quadtree_build(quadtree_t *tree) {
+  tree->num_nodes = 0;
+  if (tree->num_points == 0) {
+    return;
+  }
+  vector_t min = tree->positions[0];
+  vector_t max = tree->positions[0];
+  for (size_t i = 1; i < tree->num_points; i++) {
+    min.x = fmin(min.x, tree->positions[i].x);
+    min.y = fmin(min.y, tree->positions[i].y);
+    max.x = fmax(max.x, tree->positions[i].x);
+    max.y = fmax(max.y, tree->positions[i].y);
+  }
+  // make room for the root; the rest of the group is reused by its children
+  quad_allocate_children(tree);
+  tree->num_nodes = 1;
+  tree->nodes[0] = (quadtree_node_t){
+      .center = vec_multiply(0.5, vec_add(min, max)),
+      .half_size = fmax(max.x - min.x, max.y - min.y) / 2,
+      .start = 0,
+      .end = tree->num_points};
+  quad_build_node(tree, 0, 0);
+}
+
+// adds the pull of a point mass to the field, if it is far enough away.
+// This is the innermost loop, so it avoids the vector.h helpers,
+// which can't be inlined from another file
+vector_t quad_add_pull(vector_t field, vector_t point, vector_t position,
+                       double mass, double min_distance) {
+  double dx = position.x - point.x;
+  double dy = position.y - point.y;
+  double distance = sqrt(dx * dx + dy * dy);
+  if (distance == 0 || distance < min_distance) {
+    return field;
+  }
+  double strength = mass / (distance * distance * distance);
+  field.x += strength * dx;
+  field.y += strength * dy;
+  return field;
+}
+
+bool quad_contains(quadtree_node_t *node, vector_t point) {
+  return fabs(point.x - node->center.x) <= node->half_size &&
+         fabs(point.y - node->center.y) <= node->half_size;
+}
+
+vector_t quadtree_field(quadtree_t *tree, vector_t point, double theta,
+                        double min_distance) {
+  assert(theta >= 0);
+  vector_t field = VEC_ZERO;
+  if (tree->num_nodes == 0) {
+    return field;
+  }
+  size_t stack[QUAD_STACK_SIZE];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0) {
+    quadtree_node_t *node = &tree->nodes[stack[--stack_size]];
+    if (node->mass == 0) {
+      continue;
+    }
+    if (node->first_child == QUAD_NO_CHILDREN) {
+      for (size_t i = node->start; i < node->end; i++) {
+        field = quad_add_pull(field, point, tree->positions[i],
+                              tree->masses[i], min_distance);
+      }
+      continue;
+    }
+    // a node containing the point would pull the point on itself
+    if (!quad_contains(node, point)) {
+      double distance = vec_l2norm(node->center_of_mass, point);
+      if (2 * node->half_size < theta * distance) {
+        field = quad_add_pull(field, point, node->center_of_mass, node->mass,
+                              min_distance);
+        continue;
+      }
+    }
+    for (size_t i = 0; i < 4; i++) {
+      stack[stack_size++] = node->first_child + i;
+    }
+  }
+  return field;
+}
@@ -1,16 +1,133 @@
 #include "scene.h"
+#include "aabb_tree.h"
+#include "arena.h"
 #include "body.h"
+#include "collision.h"
 #include "forces.h"
+#include "kinematics.h"
 #include "list.h"
+#include "pool.h"
+#include "spatial_hash.h"
+#include "thread_pool.h"
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 const size_t INITIAL_NUM_BODIES = 2;
+// the size of the records in scene_aux_pool(), enough for a few pointers,
+// handles and numbers
+const size_t SCENE_AUX_SIZE = 96;
+// the initial size of the frame arena; it grows to fit the largest frame
+const size_t SCENE_FRAME_ARENA_SIZE = 16384;
+const double SCENE_DEFAULT_FIXED_STEP = 1.0 / 120;
+const size_t SCENE_DEFAULT_MAX_SUBSTEPS = 8;
+
+// the functions passed to scene_set_hooks(), or NULL
+scene_hook_t scene_init_hook = NULL;
+scene_hook_t scene_free_hook = NULL;
+
+typedef struct force {
+  force_creator_t forcer;
+  void *aux;
+  free_func_t aux_freer;
+  list_t *bodies;
+  // the pool the force was taken from, or NULL if it was malloc()ed
+  pool_t *pool;
+  // whether the creator only changes its bodies through body_add_force(),
+  // so its forces can be logged and added up later in the serial order
+  bool additive;
+  // the creator's index in the scene's list, set when the forces are colored
+  size_t order;
+} force_t;
+
+// where a handle finds its body. When the body is removed, the generation is
+// bumped so old handles to the slot stop resolving
+typedef struct body_slot {
+  body_t *body;
+  size_t generation;
+  // the next unused slot, if this one is unused
+  size_t next_free;
+} body_slot_t;
+
+// marks the end of the list of unused slots
+const size_t SCENE_NO_FREE_SLOT = SIZE_MAX;
+
+// the colors already taken by additive forces on one body, as a bit set
+typedef struct color_set {
+  uint64_t *words;
+  size_t num_words;
+} color_set_t;
+
+// a pair of bodies found by the broad phase, for threaded collision checks
+typedef struct body_pair {
+  body_t *body1;
+  body_t *body2;
+  bool colliding;
+} body_pair_t;
 
 typedef struct scene {
   list_t *bodies;
   list_t *forces;
+  collision_handler_t collision_handler;
+  void *collision_aux;
+  free_func_t collision_aux_freer;
+  // broad phase for collision detection. at most one is non-NULL;
+  // if both are NULL, every pair is tested
+  spatial_hash_t *spatial_hash;
+  aabb_tree_t *aabb_tree;
+  // memory for the bodies, forces and force aux records created through the
+  // scene, so adding and removing them doesn't call malloc() or free()
+  pool_t *body_pool;
+  pool_t *force_pool;
+  pool_t *aux_pool;
+  // scratch memory for the current frame, released after each tick
+  arena_t *frame_arena;
+  // the slots handed out by scene_get_handle(), indexed by body_handle_t
+  body_slot_t *slots;
+  size_t num_slots;
+  size_t slots_capacity;
+  size_t first_free_slot;
+  // if non-NULL, holds the kinematic state of every body in the scene,
+  // so integration is one loop over dense arrays
+  kinematics_t *kinematics;
+  // if non-NULL, force creators and integration are spread over its threads
+  thread_pool_t *threads;
+  // the force creators in the order a threaded tick runs them, grouped into
+  // colors whose creators can run at the same time. Color i is
+  // colored_forces[color_starts[i]] to colored_forces[color_starts[i + 1] - 1]
+  force_t **colored_forces;
+  size_t *color_starts;
+  size_t num_colors;
+  // set when forces or bodies change, so the colors are rebuilt next tick
+  bool colors_stale;
+  // scratch space for color_forces(), kept between rebuilds so a scene whose
+  // bodies and forces change every tick doesn't allocate every tick.
+  // colored_forces and force_colors have room for colored_capacity forces,
+  // color_starts for color_starts_capacity colors, and the per-slot arrays
+  // for color_slots_capacity slots
+  size_t colored_capacity;
+  size_t color_starts_capacity;
+  size_t *force_colors;
+  color_set_t *taken_colors;
+  size_t *after_ordered;
+  size_t *after_any;
+  size_t color_slots_capacity;
+  // the step scene_advance() ticks by, and the most ticks it runs per call
+  double fixed_step;
+  size_t max_substeps;
+  // the time scene_advance() has been given but not yet simulated
+  double accumulator;
+  // how far the accumulator is into the next step, as a fraction of a step
+  double interpolation_alpha;
+  // the candidate pairs of a threaded tick's collision check
+  body_pair_t *pairs;
+  size_t num_pairs;
+  size_t pairs_capacity;
+  // the work scene_tick() has done, for scene_get_tick_totals()
+  scene_tick_totals_t tick_totals;
 } scene_t;
 
 scene_t *scene_init() {
@@ -18,30 +135,98 @@ scene_t *scene_init() {
   assert(scene != NULL);
   scene->bodies = list_init(INITIAL_NUM_BODIES, (free_func_t)body_free);
   scene->forces = list_init(INITIAL_NUM_BODIES, (free_func_t)force_free);
+  scene->collision_handler = NULL;
+  scene->collision_aux = NULL;
+  scene->collision_aux_freer = NULL;
+  scene->spatial_hash = NULL;
+  scene->aabb_tree = NULL;
+  scene->body_pool = body_pool_init();
+  scene->force_pool = pool_init(sizeof(force_t));
+  scene->aux_pool = pool_init(SCENE_AUX_SIZE);
+  scene->frame_arena = arena_init(SCENE_FRAME_ARENA_SIZE);
+  scene->slots = NULL;
+  scene->num_slots = 0;
+  scene->slots_capacity = 0;
+  scene->first_free_slot = SCENE_NO_FREE_SLOT;
+  scene->kinematics = NULL;
+  scene->threads = NULL;
+  scene->colored_forces = NULL;
+  scene->color_starts = NULL;
+  scene->num_colors = 0;
+  scene->colors_stale = true;
+  scene->colored_capacity = 0;
+  scene->color_starts_capacity = 0;
+  scene->force_colors = NULL;
+  scene->taken_colors = NULL;
+  scene->after_ordered = NULL;
+  scene->after_any = NULL;
+  scene->color_slots_capacity = 0;
+  scene->pairs = NULL;
+  scene->num_pairs = 0;
+  scene->pairs_capacity = 0;
+  scene->fixed_step = SCENE_DEFAULT_FIXED_STEP;
+  scene->max_substeps = SCENE_DEFAULT_MAX_SUBSTEPS;
+  scene->accumulator = 0;
+  scene->interpolation_alpha = 1;
+  scene->tick_totals = (scene_tick_totals_t){.ticks = 0, .body_updates = 0};
+  if (scene_init_hook != NULL) {
+    scene_init_hook(scene);
+  }
   return scene;
 }
 
 void scene_free(scene_t *scene) {
+  if (scene_free_hook != NULL) {
+    scene_free_hook(scene);
+  }
   list_free(scene->bodies);
   list_free(scene->forces);
+  if (scene->collision_aux_freer != NULL) {
+    scene->collision_aux_freer(scene->collision_aux);
+  }
+  if (scene->spatial_hash != NULL) {
+    spatial_hash_free(scene->spatial_hash);
+  }
+  if (scene->aabb_tree != NULL) {
+    aabb_tree_free(scene->aabb_tree);
+  }
+  // the pooled objects were all freed with the lists above
+  pool_free(scene->body_pool);
+  pool_free(scene->force_pool);
+  pool_free(scene->aux_pool);
+  arena_free(scene->frame_arena);
+  free(scene->slots);
+  // the bodies were detached from it as they were freed
+  if (scene->kinematics != NULL) {
+    kinematics_free(scene->kinematics);
+  }
+  if (scene->threads != NULL) {
+    thread_pool_free(scene->threads);
+  }
+  free(scene->colored_forces);
+  free(scene->color_starts);
+  free(scene->force_colors);
+  for (size_t i = 0; i < scene->color_slots_capacity; i++) {
+    free(scene->taken_colors[i].words);
+  }
+  free(scene->taken_colors);
+  free(scene->after_ordered);
+  free(scene->after_any);
+  free(scene->pairs);
   free(scene);
 }
 
-typedef struct force {
-  force_creator_t forcer;
-  void *aux;
-  free_func_t aux_freer;
-  list_t *bodies;
-} force_t;
 
 force_t *force_init(force_creator_t forcer, void *aux_data, list_t *bodies,
                     free_func_t aux_freer) {
   force_t *force = malloc(sizeof(force_t));
   assert(force != NULL);
+  force->pool = NULL;
   force->forcer = *forcer;
   force->aux = aux_data;
   force->aux_freer = aux_freer;
   force->bodies = bodies;
+  force->additive = false;
   return force;
 }
 
@@ -52,7 +237,11 @@ void force_free(force_t *forcer) {
   if (forcer->bodies != NULL) {
     list_free(forcer->bodies);
   }
-  free(forcer);
+  if (forcer->pool != NULL) {
+    pool_release(forcer->pool, forcer);
+  } else {
+    free(forcer);
+  }
 }
 
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
@@ -65,58 +254,670 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
 
 list_t *scene_get_all_bodies(scene_t *scene) { return scene->bodies; }
 
+// gives a body a slot, so handles can be issued for it
+void acquire_body_slot(scene_t *scene, body_t *body) {
+  assert(body_get_scene_slot(body) == BODY_NO_SCENE_SLOT);
+  size_t slot = scene->first_free_slot;
+  if (slot != SCENE_NO_FREE_SLOT) {
+    scene->first_free_slot = scene->slots[slot].next_free;
+  } else {
+    if (scene->num_slots == scene->slots_capacity) {
+      size_t capacity =
+          scene->slots_capacity == 0 ? 16 : scene->slots_capacity * 2;
+      scene->slots = realloc(scene->slots, sizeof(body_slot_t) * capacity);
+      assert(scene->slots != NULL);
+      scene->slots_capacity = capacity;
+    }
+    slot = scene->num_slots++;
+    scene->slots[slot].generation = 0;
+  }
+  scene->slots[slot].body = body;
+  body_set_scene_slot(body, slot);
+}
+
+// frees a removed body's slot, invalidating its handles
+void release_body_slot(scene_t *scene, body_t *body) {
+  size_t slot = body_get_scene_slot(body);
+  scene->slots[slot].body = NULL;
+  scene->slots[slot].generation++;
+  scene->slots[slot].next_free = scene->first_free_slot;
+  scene->first_free_slot = slot;
+  body_set_scene_slot(body, BODY_NO_SCENE_SLOT);
+}
+
 void scene_add_body(scene_t *scene, body_t *body) {
+  acquire_body_slot(scene, body);
+  if (scene->kinematics != NULL) {
+    body_attach_kinematics(body, scene->kinematics);
+  }
   list_add(scene->bodies, body);
+  // forces created before their bodies were added can now be colored
+  scene->colors_stale = true;
+  // a body placed after body_init() shouldn't be drawn sliding from its
+  // initial position
+  body_save_transform(body);
+}
+
+void scene_set_dense_storage(scene_t *scene) {
+  if (scene->kinematics != NULL) {
+    return;
+  }
+  size_t body_count = scene_bodies(scene);
+  scene->kinematics = kinematics_init(body_count);
+  for (size_t i = 0; i < body_count; i++) {
+    body_attach_kinematics(list_get(scene->bodies, i), scene->kinematics);
+  }
+}
+
+void scene_set_threads(scene_t *scene, size_t num_threads) {
+  if (scene->threads != NULL) {
+    thread_pool_free(scene->threads);
+    scene->threads = NULL;
+  }
+  if (num_threads > 1) {
+    scene->threads = thread_pool_init(num_threads);
+  }
+}
+
+thread_pool_t *scene_get_threads(scene_t *scene) { return scene->threads; }
+
+bool scene_has_body(scene_t *scene, body_t *body) {
+  size_t slot = body_get_scene_slot(body);
+  return slot < scene->num_slots && scene->slots[slot].body == body;
+}
+
+body_handle_t scene_get_handle(scene_t *scene, body_t *body) {
+  assert(scene_has_body(scene, body));
+  size_t slot = body_get_scene_slot(body);
+  return (body_handle_t){.index = slot,
+                         .generation = scene->slots[slot].generation};
+}
+
+body_t *scene_resolve(scene_t *scene, body_handle_t handle) {
+  if (handle.index >= scene->num_slots) {
+    return NULL;
+  }
+  body_slot_t *slot = &scene->slots[handle.index];
+  return slot->generation == handle.generation ? slot->body : NULL;
 }
 
-bool force_is_removed(force_t *force, body_t *rem) {
+body_t *scene_body_init(scene_t *scene, list_t *shape, double mass,
+                        rgb_color_t color, void *info,
+                        free_func_t info_freer) {
+  body_t *body = body_init_from_pool(scene->body_pool, shape, mass, color,
+                                     info, info_freer);
+  scene_add_body(scene, body);
+  return body;
+}
+
+pool_t *scene_aux_pool(scene_t *scene) { return scene->aux_pool; }
+
+arena_t *scene_frame_arena(scene_t *scene) { return scene->frame_arena; }
+
+void scene_frame_begin(scene_t *scene) { arena_reset(scene->frame_arena); }
+
+// whether any of the bodies a force acts on is about to be removed
+bool force_is_removed(void *element, void *aux) {
+  force_t *force = element;
+  // forces added without a list of bodies are never removed
+  if (force->bodies == NULL) {
+    return false;
+  }
   list_t *bodies = force->bodies;
   for (size_t i = 0; i < list_size(bodies); i++) {
-    if ((body_t *)list_get(bodies, i) == rem) {
+    if (body_is_removed((body_t *)list_get(bodies, i))) {
       return true;
     }
   }
   return false;
 }
 
-// this function removes the necessary bodies from the scene
+// whether a body is about to be removed from the scene.
+// If so, also takes it out of the scene's AABB tree before it is freed
+bool body_is_reaped(void *element, void *aux) {
+  body_t *body = element;
+  scene_t *scene = aux;
+  if (!body_is_removed(body)) {
+    return false;
+  }
+  if (scene->aabb_tree != NULL) {
+    aabb_tree_remove(scene->aabb_tree, body);
+  }
+  release_body_slot(scene, body);
+  return true;
+}
+
+// removes the bodies marked with body_remove() and the forces acting on
+// them. Each list is compacted in a single pass that keeps the remaining
+// elements in order, so this is O(bodies + forces) however many are removed
 void remove_bodies(scene_t *scene) {
   list_t *bodies = scene->bodies;
-  list_t *forces = scene->forces;
-  size_t bodies_idx = 0;
-  // using while loop instead of for loop cuz modifying list(s) as iterating
-  // through it
-  while (bodies_idx < list_size(bodies)) {
-    body_t *temp_body = (body_t *)list_get(bodies, bodies_idx);
-    if (body_is_removed(temp_body)) {
-      size_t forces_idx = 0;
-      while (forces_idx < list_size(forces)) {
-        if (force_is_removed((force_t *)list_get(forces, forces_idx),
-                             temp_body)) {
-          force_free(list_remove(forces, forces_idx));
+  size_t body_count = list_size(bodies);
+  bool any_removed = false;
+  for (size_t i = 0; i < body_count && !any_removed; i++) {
+    any_removed = body_is_removed((body_t *)list_get(bodies, i));
+  }
+  if (!any_removed) {
+    return;
+  }
+  // forces must go first, since they check their bodies' flags
+  list_remove_if(scene->forces, force_is_removed, NULL, true);
+  list_remove_if(bodies, body_is_reaped, scene, true);
+  scene->colors_stale = true;
+}
+
+void scene_set_collision_handler(scene_t *scene, collision_handler_t handler,
+                                 void *aux, free_func_t freer) {
+  if (scene->collision_aux_freer != NULL) {
+    scene->collision_aux_freer(scene->collision_aux);
+  }
+  scene->collision_handler = handler;
+  scene->collision_aux = aux;
+  scene->collision_aux_freer = freer;
+}
+
+void clear_broad_phase(scene_t *scene) {
+  if (scene->spatial_hash != NULL) {
+    spatial_hash_free(scene->spatial_hash);
+    scene->spatial_hash = NULL;
+  }
+  if (scene->aabb_tree != NULL) {
+    aabb_tree_free(scene->aabb_tree);
+    scene->aabb_tree = NULL;
+  }
+}
+
+void scene_set_spatial_hash(scene_t *scene, double cell_size) {
+  clear_broad_phase(scene);
+  scene->spatial_hash = spatial_hash_init(cell_size);
+}
+
+void scene_set_aabb_tree(scene_t *scene, double margin) {
+  clear_broad_phase(scene);
+  scene->aabb_tree = aabb_tree_init(margin);
+}
+
+// moves every body's leaf in the tree to its current position
+void update_aabb_tree(scene_t *scene) {
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    aabb_tree_update(scene->aabb_tree, list_get(scene->bodies, i));
+  }
+}
+
+// narrow phase: called on each candidate pair found by the broad phase
+void check_candidate_pair(body_t *body1, body_t *body2, void *aux) {
+  scene_t *scene = aux;
+  if (body_is_removed(body1) || body_is_removed(body2)) {
+    return;
+  }
+  if (find_body_collision(body1, body2)) {
+    scene->collision_handler(body1, body2, scene->collision_aux);
+  }
+}
+
+// brings the shapes and bounding boxes of the bodies with indices start to
+// end - 1 up to date
+void refresh_shape_range(void *aux, size_t start, size_t end) {
+  scene_t *scene = aux;
+  for (size_t i = start; i < end; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    body_peek_shape(body);
+    body_get_bounding_box(body);
+  }
+}
+
+void scene_update_shapes(scene_t *scene) {
+  if (scene->threads != NULL) {
+    thread_pool_for(scene->threads, scene_bodies(scene), 0,
+                    refresh_shape_range, scene);
+  } else {
+    refresh_shape_range(scene, 0, scene_bodies(scene));
+  }
+}
+
+// collects a pair found by the broad phase
+void add_candidate_pair(body_t *body1, body_t *body2, void *aux) {
+  scene_t *scene = aux;
+  if (scene->num_pairs == scene->pairs_capacity) {
+    size_t capacity = scene->pairs_capacity == 0 ? 64 : scene->pairs_capacity * 2;
+    scene->pairs = realloc(scene->pairs, sizeof(body_pair_t) * capacity);
+    assert(scene->pairs != NULL);
+    scene->pairs_capacity = capacity;
+  }
+  scene->pairs[scene->num_pairs++] =
+      (body_pair_t){.body1 = body1, .body2 = body2, .colliding = false};
+}
+
+// runs the narrow phase on the candidate pairs start to end - 1. The shapes
+// are already up to date, so this only reads the bodies
+void test_pair_range(void *aux, size_t start, size_t end) {
+  scene_t *scene = aux;
+  for (size_t i = start; i < end; i++) {
+    body_pair_t *pair = &scene->pairs[i];
+    pair->colliding = find_body_collision(pair->body1, pair->body2);
+  }
+}
+
+// finds collisions like find_scene_collisions(), but tests the candidate
+// pairs on the scene's threads. The handlers run afterwards, in the order
+// the broad phase found the pairs
+void find_scene_collisions_threaded(scene_t *scene) {
+  scene_update_shapes(scene);
+  scene->num_pairs = 0;
+  if (scene->spatial_hash != NULL) {
+    spatial_hash_rebuild(scene->spatial_hash, scene->bodies);
+    spatial_hash_query_pairs(scene->spatial_hash, add_candidate_pair, scene);
+  } else if (scene->aabb_tree != NULL) {
+    update_aabb_tree(scene);
+    aabb_tree_query_pairs(scene->aabb_tree, add_candidate_pair, scene);
+  } else {
+    // the bounding boxes are cached, so comparing them is a cheap broad phase
+    size_t body_count = scene_bodies(scene);
+    for (size_t i = 0; i < body_count; i++) {
+      body_t *body1 = list_get(scene->bodies, i);
+      bounding_box_t box = body_get_bounding_box(body1);
+      for (size_t j = i + 1; j < body_count; j++) {
+        body_t *body2 = list_get(scene->bodies, j);
+        if (bounding_box_overlaps(box, body_get_bounding_box(body2))) {
+          add_candidate_pair(body1, body2, scene);
+        }
+      }
+    }
+  }
+  thread_pool_for(scene->threads, scene->num_pairs, 0, test_pair_range, scene);
+  for (size_t i = 0; i < scene->num_pairs; i++) {
+    body_pair_t *pair = &scene->pairs[i];
+    if (pair->colliding && !body_is_removed(pair->body1) &&
+        !body_is_removed(pair->body2)) {
+      scene->collision_handler(pair->body1, pair->body2, scene->collision_aux);
+    }
+  }
+}
+
+void find_scene_collisions(scene_t *scene) {
+  if (scene->threads != NULL) {
+    find_scene_collisions_threaded(scene);
+    return;
+  }
+  if (scene->spatial_hash != NULL) {
+    spatial_hash_rebuild(scene->spatial_hash, scene->bodies);
+    spatial_hash_query_pairs(scene->spatial_hash, check_candidate_pair, scene);
+    return;
+  }
+  if (scene->aabb_tree != NULL) {
+    update_aabb_tree(scene);
+    aabb_tree_query_pairs(scene->aabb_tree, check_candidate_pair, scene);
+    return;
+  }
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    for (size_t j = i + 1; j < body_count; j++) {
+      check_candidate_pair(list_get(scene->bodies, i),
+                           list_get(scene->bodies, j), scene);
+    }
+  }
+}
+
+// whether the scene knows every body a force acts on, so it can run
+// alongside forces on other bodies
+bool force_is_declared(scene_t *scene, force_t *force) {
+  if (force->bodies == NULL || list_size(force->bodies) == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < list_size(force->bodies); i++) {
+    if (!scene_has_body(scene, list_get(force->bodies, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void color_set_add(color_set_t *set, size_t color) {
+  size_t word = color / 64;
+  if (word >= set->num_words) {
+    size_t num_words = word * 2 + 1;
+    set->words = realloc(set->words, sizeof(uint64_t) * num_words);
+    assert(set->words != NULL);
+    for (size_t i = set->num_words; i < num_words; i++) {
+      set->words[i] = 0;
+    }
+    set->num_words = num_words;
+  }
+  set->words[word] |= (uint64_t)1 << (color % 64);
+}
+
+// finds the first color from min_color on that none of the bodies has taken
+size_t color_first_free(color_set_t *sets, list_t *bodies, size_t min_color) {
+  for (size_t word = min_color / 64;; word++) {
+    uint64_t taken = 0;
+    if (word == min_color / 64) {
+      taken = ((uint64_t)1 << (min_color % 64)) - 1;
+    }
+    for (size_t i = 0; i < list_size(bodies); i++) {
+      color_set_t *set = &sets[body_get_scene_slot(list_get(bodies, i))];
+      if (word < set->num_words) {
+        taken |= set->words[word];
+      }
+    }
+    if (taken != UINT64_MAX) {
+      return word * 64 + __builtin_ctzll(~taken);
+    }
+  }
+}
+
+// grows the scratch space of color_forces() to fit the scene's forces and
+// slots, doubling it so a growing scene only reallocates now and then, and
+// clears the per-slot arrays
+void reserve_color_buffers(scene_t *scene, size_t force_count) {
+  if (force_count + 1 > scene->colored_capacity) {
+    size_t capacity = scene->colored_capacity * 2;
+    capacity = capacity > force_count + 1 ? capacity : force_count + 1;
+    scene->colored_forces =
+        realloc(scene->colored_forces, sizeof(force_t *) * capacity);
+    scene->force_colors =
+        realloc(scene->force_colors, sizeof(size_t) * capacity);
+    assert(scene->colored_forces != NULL && scene->force_colors != NULL);
+    scene->colored_capacity = capacity;
+  }
+  if (scene->num_slots > scene->color_slots_capacity) {
+    size_t capacity = scene->color_slots_capacity * 2;
+    capacity = capacity > scene->num_slots ? capacity : scene->num_slots;
+    scene->taken_colors =
+        realloc(scene->taken_colors, sizeof(color_set_t) * capacity);
+    scene->after_ordered =
+        realloc(scene->after_ordered, sizeof(size_t) * capacity);
+    scene->after_any = realloc(scene->after_any, sizeof(size_t) * capacity);
+    assert(scene->taken_colors != NULL);
+    assert(scene->after_ordered != NULL && scene->after_any != NULL);
+    for (size_t i = scene->color_slots_capacity; i < capacity; i++) {
+      scene->taken_colors[i] = (color_set_t){.words = NULL, .num_words = 0};
+    }
+    scene->color_slots_capacity = capacity;
+  }
+  // the bit sets keep their words, so they don't have to grow again
+  for (size_t i = 0; i < scene->num_slots; i++) {
+    color_set_t *set = &scene->taken_colors[i];
+    if (set->num_words > 0) {
+      memset(set->words, 0, sizeof(uint64_t) * set->num_words);
+    }
+    scene->after_ordered[i] = 0;
+    scene->after_any[i] = 0;
+  }
+}
+
+// greedily colors the conflict graph of the forces for a threaded tick, so
+// forces of the same color can run at the same time. Forces conflict if they
+// share a body, but additive forces on the same body only need different
+// colors: their forces are logged and added up in list order afterwards, so
+// they may run in any order. Every other force reads or replaces its bodies'
+// forces, so it comes after every earlier force on its bodies, and before
+// every later one. Either way, each body ends up with exactly the same forces
+// as in a serial tick, whatever the number of threads.
+// A force with undeclared bodies could touch anything, so it gets a color of
+// its own, after all earlier forces and before all later ones
+void color_forces(scene_t *scene) {
+  size_t force_count = scene_forces(scene);
+  reserve_color_buffers(scene, force_count);
+  size_t *force_colors = scene->force_colors;
+  // for the body in each slot, the colors taken by its additive forces, the
+  // first color after its last ordered force, and the first color after its
+  // last force of either kind
+  color_set_t *taken = scene->taken_colors;
+  size_t *after_ordered = scene->after_ordered;
+  size_t *after_any = scene->after_any;
+  size_t first_open_color = 0;
+  size_t num_colors = 0;
+  for (size_t i = 0; i < force_count; i++) {
+    force_t *force = list_get(scene->forces, i);
+    force->order = i;
+    size_t color = first_open_color;
+    if (force_is_declared(scene, force)) {
+      list_t *bodies = force->bodies;
+      for (size_t j = 0; j < list_size(bodies); j++) {
+        size_t slot = body_get_scene_slot(list_get(bodies, j));
+        size_t after = force->additive ? after_ordered[slot] : after_any[slot];
+        color = after > color ? after : color;
+      }
+      if (force->additive) {
+        color = color_first_free(taken, bodies, color);
+      }
+      for (size_t j = 0; j < list_size(bodies); j++) {
+        size_t slot = body_get_scene_slot(list_get(bodies, j));
+        if (force->additive) {
+          color_set_add(&taken[slot], color);
         } else {
-          forces_idx += 1;
+          after_ordered[slot] = color + 1;
         }
+        after_any[slot] = color + 1 > after_any[slot] ? color + 1 : after_any[slot];
       }
-      body_free(list_remove(bodies, bodies_idx));
     } else {
-      bodies_idx += 1;
+      color = num_colors;
+      first_open_color = color + 1;
+    }
+    force_colors[i] = color;
+    num_colors = color + 1 > num_colors ? color + 1 : num_colors;
+  }
+
+  // a counting sort by color, keeping the forces of each color in order
+  if (num_colors + 1 > scene->color_starts_capacity) {
+    size_t capacity = scene->color_starts_capacity * 2;
+    capacity = capacity > num_colors + 1 ? capacity : num_colors + 1;
+    scene->color_starts =
+        realloc(scene->color_starts, sizeof(size_t) * capacity);
+    assert(scene->color_starts != NULL);
+    scene->color_starts_capacity = capacity;
+  }
+  memset(scene->color_starts, 0, sizeof(size_t) * (num_colors + 1));
+  for (size_t i = 0; i < force_count; i++) {
+    scene->color_starts[force_colors[i] + 1]++;
+  }
+  for (size_t c = 0; c < num_colors; c++) {
+    scene->color_starts[c + 1] += scene->color_starts[c];
+  }
+  for (size_t i = 0; i < force_count; i++) {
+    scene->colored_forces[scene->color_starts[force_colors[i]]++] =
+        list_get(scene->forces, i);
+  }
+  // the loop above moved each start to the next color's start
+  for (size_t c = num_colors; c > 0; c--) {
+    scene->color_starts[c] = scene->color_starts[c - 1];
+  }
+  scene->color_starts[0] = 0;
+  scene->num_colors = num_colors;
+  scene->colors_stale = false;
+}
+
+// runs the force creators forces[start] to forces[end - 1]
+void apply_force_range(void *aux, size_t start, size_t end) {
+  force_t **forces = aux;
+  for (size_t i = start; i < end; i++) {
+    force_t *force = forces[i];
+    if (force->additive) {
+      body_set_force_order(force->order);
+      force->forcer(force->aux);
+      body_set_force_order(BODY_NO_FORCE_ORDER);
+      continue;
+    }
+    // the creator sees its bodies' forces, so add up the logged ones first
+    if (force->bodies != NULL) {
+      for (size_t j = 0; j < list_size(force->bodies); j++) {
+        body_apply_force_log(list_get(force->bodies, j));
+      }
+    }
+    force->forcer(force->aux);
+  }
+}
+
+// adds up the logged forces of the bodies with indices start to end - 1
+void apply_force_log_range(void *aux, size_t start, size_t end) {
+  scene_t *scene = aux;
+  for (size_t i = start; i < end; i++) {
+    body_apply_force_log(scene_get_body(scene, i));
+  }
+}
+
+void apply_forces(scene_t *scene) {
+  if (scene->threads == NULL) {
+    // force creators may add more forces, which also run this tick
+    for (size_t i = 0; i < list_size(scene->forces); i++) {
+      force_t *force = (force_t *)list_get(scene->forces, i);
+      force->forcer(force->aux);
     }
+    return;
+  }
+  if (scene->colors_stale) {
+    color_forces(scene);
+  }
+  size_t num_bodies = scene_bodies(scene);
+  for (size_t c = 0; c < scene->num_colors; c++) {
+    size_t start = scene->color_starts[c];
+    size_t count = scene->color_starts[c + 1] - start;
+    // a force with undeclared bodies is alone in its color,
+    // and may look at any body's force
+    if (count == 1 && !force_is_declared(scene, scene->colored_forces[start])) {
+      thread_pool_for(scene->threads, num_bodies, 0, apply_force_log_range,
+                      scene);
+    }
+    thread_pool_for(scene->threads, count, 0, apply_force_range,
+                    &scene->colored_forces[start]);
+  }
+  thread_pool_for(scene->threads, num_bodies, 0, apply_force_log_range, scene);
+}
+
+typedef struct {
+  scene_t *scene;
+  double dt;
+} tick_range_t;
+
+// ticks the bodies with indices start to end - 1
+void tick_body_range(void *aux, size_t start, size_t end) {
+  tick_range_t *range = aux;
+  scene_t *scene = range->scene;
+  if (scene->kinematics != NULL) {
+    // the store is in a different order, but covers the same bodies
+    kinematics_integrate_range(scene->kinematics, range->dt, start, end);
+    return;
+  }
+  for (size_t i = start; i < end; i++) {
+    body_tick((body_t *)(list_get(scene->bodies, i)), range->dt);
   }
 }
 
 void scene_tick(scene_t *scene, double dt) {
   // apply every force in the forces list
-  for (size_t i = 0; i < list_size(scene->forces); i++) {
-    force_t *force = (force_t *)list_get(scene->forces, i);
-    force->forcer(force->aux);
+  apply_forces(scene);
+  // handle collisions between bodies
+  if (scene->collision_handler != NULL) {
+    find_scene_collisions(scene);
   }
   // tick the bodies
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_tick((body_t *)(list_get(scene->bodies, i)), dt);
+  scene->tick_totals.ticks++;
+  scene->tick_totals.body_updates += scene_bodies(scene);
+  tick_range_t range = {.scene = scene, .dt = dt};
+  if (scene->threads != NULL) {
+    thread_pool_for(scene->threads, scene_bodies(scene), 0, tick_body_range,
+                    &range);
+  } else {
+    tick_body_range(&range, 0, scene_bodies(scene));
   }
   // remove the necessary bodies
   remove_bodies(scene);
+  // keep the tree current for scene_query_box() and scene_query_ray()
+  if (scene->aabb_tree != NULL) {
+    update_aabb_tree(scene);
+  }
+  // anything allocated for this frame is no longer needed
+  scene_frame_begin(scene);
+  // bodies are drawn where this tick left them, unless scene_advance() says
+  // otherwise
+  scene->interpolation_alpha = 1;
+}
+
+void scene_set_fixed_step(scene_t *scene, double step, size_t max_substeps) {
+  assert(step > 0 && isfinite(step));
+  assert(max_substeps > 0);
+  scene->fixed_step = step;
+  scene->max_substeps = max_substeps;
+}
+
+// saves the transforms of the bodies with indices start to end - 1
+void save_transform_range(void *aux, size_t start, size_t end) {
+  scene_t *scene = aux;
+  for (size_t i = start; i < end; i++) {
+    body_save_transform(list_get(scene->bodies, i));
+  }
+}
+
+size_t scene_advance(scene_t *scene, double wall_dt) {
+  assert(wall_dt >= 0);
+  // a frame may run no ticks, so release the last frame's memory here too
+  scene_frame_begin(scene);
+  scene->accumulator += wall_dt;
+  size_t substeps = 0;
+  while (scene->accumulator >= scene->fixed_step &&
+         substeps < scene->max_substeps) {
+    if (scene->threads != NULL) {
+      thread_pool_for(scene->threads, scene_bodies(scene), 0,
+                      save_transform_range, scene);
+    } else {
+      save_transform_range(scene, 0, scene_bodies(scene));
+    }
+    scene_tick(scene, scene->fixed_step);
+    scene->accumulator -= scene->fixed_step;
+    substeps++;
+  }
+  if (scene->accumulator >= scene->fixed_step) {
+    // the ticks take longer than the time they simulate, so catching up
+    // would only fall further behind. Drop the backlog and run slow instead
+    scene->accumulator = fmod(scene->accumulator, scene->fixed_step);
+  }
+  scene->interpolation_alpha = scene->accumulator / scene->fixed_step;
+  return substeps;
+}
+
+double scene_interpolation_alpha(scene_t *scene) {
+  return scene->interpolation_alpha;
+}
+
+scene_tick_totals_t scene_get_tick_totals(scene_t *scene) {
+  return scene->tick_totals;
+}
+
+void scene_set_hooks(scene_hook_t on_init, scene_hook_t on_free) {
+  scene_init_hook = on_init;
+  scene_free_hook = on_free;
+}
+
+void scene_query_box(scene_t *scene, bounding_box_t box,
+                     body_query_handler_t handler, void *aux) {
+  if (scene->aabb_tree != NULL) {
+    aabb_tree_query_box(scene->aabb_tree, box, handler, aux);
+    return;
+  }
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (bounding_box_overlaps(body_get_bounding_box(body), box)) {
+      handler(body, aux);
+    }
+  }
+}
+
+void scene_query_ray(scene_t *scene, vector_t start, vector_t end,
+                     body_query_handler_t handler, void *aux) {
+  if (scene->aabb_tree != NULL) {
+    aabb_tree_query_ray(scene->aabb_tree, start, end, handler, aux);
+    return;
+  }
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (bounding_box_intersects_segment(body_get_bounding_box(body), start,
+                                        end)) {
+      handler(body, aux);
+    }
+  }
 }
 
 // depreciated. only still exists for backward compatibility
@@ -129,8 +930,30 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer) {
-  force_t *force = force_init(forcer, aux, bodies, freer);
+  force_t *force = pool_alloc(scene->force_pool);
+  force->forcer = forcer;
+  force->aux = aux;
+  force->aux_freer = freer;
+  force->bodies = bodies;
+  force->pool = scene->force_pool;
+  force->additive = false;
   list_add(scene->forces, force);
+  scene->colors_stale = true;
+}
+
+void scene_add_additive_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies,
+                                      free_func_t freer) {
+  scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
+  force_t *force = list_get(scene->forces, list_size(scene->forces) - 1);
+  force->additive = true;
+}
+
+size_t scene_force_colors(scene_t *scene) {
+  if (scene->colors_stale) {
+    color_forces(scene);
+  }
+  return scene->num_colors;
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
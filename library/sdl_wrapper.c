@@ -1,16 +1,22 @@
 #include "sdl_wrapper.h"
+#include "arena.h"
 #include "list.h"
+#include "polygon.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
+// the initial size of draw_arena; enough for polygons with 1000s of vertices
+const size_t DRAW_ARENA_SIZE = 8192;
+// the number of frame times kept for sdl_get_frame_stats(), about 10 seconds
+// at 60 frames per second
+const size_t FRAME_TIMER_HISTORY = 600;
 
 /**
  * The coordinate at the center of the screen.
@@ -38,20 +44,21 @@ key_handler_t key_handler = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * Times the calls to time_since_last_tick().
+ * NULL until it is first called.
  */
-clock_t last_clock = 0;
+frame_timer_t *frame_timer = NULL;
+/**
+ * Scratch memory for the pixel coordinates of the polygon being drawn.
+ * Reset after each polygon, so drawing doesn't call malloc() or free().
+ */
+arena_t *draw_arena = NULL;
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -113,6 +120,7 @@ void sdl_init(vector_t min, vector_t max) {
                             SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
                             SDL_WINDOW_RESIZABLE);
   renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+  draw_arena = arena_init(DRAW_ARENA_SIZE);
 }
 
 bool sdl_is_done(state_t *state) {
@@ -153,6 +161,14 @@ void sdl_clear(void) {
   SDL_RenderClear(renderer);
 }
 
+/** Fills the polygon with the given pixel coordinates */
+void fill_pixel_polygon(int16_t *x_points, int16_t *y_points, size_t n,
+                        rgb_color_t color) {
+  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
+                    color.g * 255, color.b * 255, 255);
+  arena_reset(draw_arena);
+}
+
 void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   // Check parameters
   size_t n = list_size(points);
@@ -164,10 +180,8 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   vector_t window_center = get_window_center();
 
   // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  int16_t *x_points = arena_alloc(draw_arena, sizeof(*x_points) * n),
+          *y_points = arena_alloc(draw_arena, sizeof(*y_points) * n);
   for (size_t i = 0; i < n; i++) {
     vector_t *vertex = list_get(points, i);
     vector_t pixel = get_window_position(*vertex, window_center);
@@ -176,10 +190,31 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
   }
 
   // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
-                    color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+  fill_pixel_polygon(x_points, y_points, n, color);
+}
+
+void sdl_draw_shape(polygon_t *shape, rgb_color_t color) {
+  // Check parameters
+  size_t n = shape->size;
+  assert(n >= 3);
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+
+  vector_t window_center = get_window_center();
+
+  // Convert each vertex to a point on screen
+  int16_t *x_points = arena_alloc(draw_arena, sizeof(*x_points) * n),
+          *y_points = arena_alloc(draw_arena, sizeof(*y_points) * n);
+  for (size_t i = 0; i < n; i++) {
+    vector_t vertex = {.x = shape->x[i], .y = shape->y[i]};
+    vector_t pixel = get_window_position(vertex, window_center);
+    x_points[i] = pixel.x;
+    y_points[i] = pixel.y;
+  }
+
+  // Draw polygon with the given color
+  fill_pixel_polygon(x_points, y_points, n, color);
 }
 
 void sdl_show(void) {
@@ -189,26 +224,32 @@ void sdl_show(void) {
            min = vec_subtract(center, max_diff);
   vector_t max_pixel = get_window_position(max, window_center),
            min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
+  SDL_Rect boundary = {.x = min_pixel.x,
+                       .y = max_pixel.y,
+                       .w = max_pixel.x - min_pixel.x,
+                       .h = min_pixel.y - max_pixel.y};
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_RenderDrawRect(renderer, &boundary);
 
   SDL_RenderPresent(renderer);
 }
 
 void sdl_render_scene(scene_t *scene) {
+  // transforms the shapes on the scene's threads, if it has any
+  scene_update_shapes(scene);
   sdl_clear();
+  double alpha = scene_interpolation_alpha(scene);
+  arena_t *frame_arena = scene_frame_arena(scene);
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, body_get_color(body));
-    list_free(shape);
+    // drawing only reads the vertices, so the body's own shape can be used,
+    // unless scene_advance() left it between two steps
+    polygon_t *shape =
+        alpha == 1 ? body_peek_shape(body)
+                   : body_get_interpolated_shape_in_arena(body, alpha,
+                                                          frame_arena);
+    sdl_draw_shape(shape, body_get_color(body));
   }
   sdl_show();
 }
@@ -216,10 +257,16 @@ void sdl_render_scene(scene_t *scene) {
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
-  return difference;
+  if (frame_timer == NULL) {
+    frame_timer = frame_timer_init(FRAME_TIMER_HISTORY);
+  }
+  // returns 0 the first time this is called
+  return frame_timer_tick(frame_timer);
+}
+
+frame_stats_t sdl_get_frame_stats(void) {
+  if (frame_timer == NULL) {
+    return (frame_stats_t){.count = 0};
+  }
+  return frame_timer_stats(frame_timer);
 }
@@ -0,0 +1,66 @@
+#include "frame_timer.h"
+#include "headless.h"
+#include "scene.h"
+#include "sdl_wrapper.h"
+#include "state.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Runs a demo without a window: links against headless.c instead of
+// sdl_wrapper.c, so the demo's own emscripten_init() builds its scenes.
+// Usage: bin/simrun_<demo> [frames] [frame time in seconds]
+
+const size_t DEFAULT_FRAMES = 1000;
+const double DEFAULT_FRAME_TIME = 1.0 / 60;
+
+// what the report needs, kept globally since some demos end the game by
+// calling exit() from emscripten_main()
+double frame_time;
+size_t frames_run = 0;
+double start_time;
+scene_tick_totals_t start_totals;
+bool reported = false;
+
+void report(void) {
+  if (reported) {
+    return;
+  }
+  reported = true;
+  double seconds = frame_timer_now() - start_time;
+  scene_tick_totals_t totals = headless_get_tick_totals();
+  size_t ticks = totals.ticks - start_totals.ticks;
+  size_t body_updates = totals.body_updates - start_totals.body_updates;
+  printf("%zu frames of %g s in %.3f s\n", frames_run, frame_time, seconds);
+  printf("%12.0f frames/s\n", frames_run / seconds);
+  printf("%12.0f ticks/s (%zu ticks)\n", ticks / seconds, ticks);
+  printf("%12.0f body updates/s (%zu updates)\n", body_updates / seconds,
+         body_updates);
+  frame_stats_t stats = sdl_get_frame_stats();
+  printf("frame time: min %.3f ms, avg %.3f ms, p99 %.3f ms, max %.3f ms\n",
+         stats.min_seconds * 1e3, stats.avg_seconds * 1e3,
+         stats.p99_seconds * 1e3, stats.max_seconds * 1e3);
+}
+
+int main(int argc, char *argv[]) {
+  size_t frames = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_FRAMES;
+  frame_time = argc > 2 ? strtod(argv[2], NULL) : DEFAULT_FRAME_TIME;
+  if (argc > 3 || frames == 0 || !(frame_time >= 0)) {
+    fprintf(stderr, "usage: %s [frames] [frame time in seconds]\n", argv[0]);
+    return 1;
+  }
+  headless_set_frame_time(frame_time);
+  headless_watch_scenes();
+
+  state_t *state = emscripten_init();
+  start_totals = headless_get_tick_totals();
+  start_time = frame_timer_now();
+  atexit(report);
+  for (; frames_run < frames; frames_run++) {
+    emscripten_main(state);
+  }
+  // stop the clock before freeing the demo
+  report();
+  emscripten_free(state);
+  return 0;
+}
@@ -0,0 +1,252 @@
+#include "spatial_hash.h"
+#include "body.h"
+#include "collision.h"
+#include "list.h"
+#include "polygon.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+const size_t MIN_BUCKETS = 16;
+// marks the end of a bucket's chain of entries
+const size_t NO_ENTRY = SIZE_MAX;
+const size_t SPATIAL_HASH_MAX_BODY_CELLS = 64;
+// cell coordinates are clamped to this range, so converting them to int64_t
+// is always defined and the width of a box never overflows
+const double MAX_CELL_COORDINATE = 4611686018427387904.0; // 2^62
+
+// one body stored in one cell
+typedef struct cell_entry {
+  int64_t cell_x;
+  int64_t cell_y;
+  size_t body_index;
+  // next entry in the same bucket, or NO_ENTRY
+  size_t next;
+} cell_entry_t;
+
+typedef struct spatial_hash {
+  double cell_size;
+  // bodies from the last rebuild and their bounding boxes
+  body_t **bodies;
+  bounding_box_t *boxes;
+  size_t num_bodies;
+  size_t bodies_capacity;
+  cell_entry_t *entries;
+  size_t num_entries;
+  size_t entries_capacity;
+  // indices of the bodies that span too many cells to be stored in them,
+  // in list order
+  size_t *oversized;
+  size_t num_oversized;
+  // index of the first entry in each bucket; the count is a power of 2
+  size_t *buckets;
+  size_t num_buckets;
+} spatial_hash_t;
+
+spatial_hash_t *spatial_hash_init(double cell_size) {
+  assert(cell_size > 0);
+  spatial_hash_t *hash = malloc(sizeof(spatial_hash_t));
+  assert(hash != NULL);
+  hash->cell_size = cell_size;
+  hash->bodies = NULL;
+  hash->boxes = NULL;
+  hash->num_bodies = 0;
+  hash->bodies_capacity = 0;
+  hash->entries = NULL;
+  hash->num_entries = 0;
+  hash->entries_capacity = 0;
+  hash->oversized = NULL;
+  hash->num_oversized = 0;
+  hash->buckets = NULL;
+  hash->num_buckets = 0;
+  return hash;
+}
+
+void spatial_hash_free(spatial_hash_t *hash) {
+  free(hash->bodies);
+  free(hash->boxes);
+  free(hash->entries);
+  free(hash->oversized);
+  free(hash->buckets);
+  free(hash);
+}
+
+double spatial_hash_cell_size(spatial_hash_t *hash) { return hash->cell_size; }
+
+int64_t cell_coordinate(spatial_hash_t *hash, double position) {
+  double cell = floor(position / hash->cell_size);
+  return (int64_t)fmax(-MAX_CELL_COORDINATE, fmin(cell, MAX_CELL_COORDINATE));
+}
+
+size_t cell_bucket(spatial_hash_t *hash, int64_t cell_x, int64_t cell_y) {
+  // mix the two coordinates with large odd constants so that neighbouring
+  // cells land in different buckets
+  uint64_t key = (uint64_t)cell_x * 0x9E3779B97F4A7C15ULL ^
+                 (uint64_t)cell_y * 0xC2B2AE3D27D4EB4FULL;
+  key ^= key >> 29;
+  return (size_t)key & (hash->num_buckets - 1);
+}
+
+void reserve_bodies(spatial_hash_t *hash, size_t count) {
+  if (count <= hash->bodies_capacity) {
+    return;
+  }
+  hash->bodies = realloc(hash->bodies, sizeof(body_t *) * count);
+  hash->boxes = realloc(hash->boxes, sizeof(bounding_box_t) * count);
+  hash->oversized = realloc(hash->oversized, sizeof(size_t) * count);
+  assert(hash->bodies != NULL);
+  assert(hash->boxes != NULL);
+  assert(hash->oversized != NULL);
+  hash->bodies_capacity = count;
+}
+
+void reserve_entries(spatial_hash_t *hash, size_t count) {
+  if (count > hash->entries_capacity) {
+    hash->entries = realloc(hash->entries, sizeof(cell_entry_t) * count);
+    assert(hash->entries != NULL);
+    hash->entries_capacity = count;
+  }
+  // keep the load factor at most 1/2
+  size_t num_buckets = MIN_BUCKETS;
+  while (num_buckets < count * 2) {
+    num_buckets *= 2;
+  }
+  if (num_buckets > hash->num_buckets) {
+    hash->buckets = realloc(hash->buckets, sizeof(size_t) * num_buckets);
+    assert(hash->buckets != NULL);
+    hash->num_buckets = num_buckets;
+  }
+  for (size_t i = 0; i < hash->num_buckets; i++) {
+    hash->buckets[i] = NO_ENTRY;
+  }
+}
+
+void spatial_hash_rebuild(spatial_hash_t *hash, list_t *bodies) {
+  size_t num_bodies = list_size(bodies);
+  reserve_bodies(hash, num_bodies);
+  hash->num_bodies = num_bodies;
+
+  // first pass: find each body's box and count how many cells are needed.
+  // A body spanning too many cells is kept out of the grid instead, so one
+  // huge body can't make the grid huge
+  size_t num_entries = 0;
+  hash->num_oversized = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_t *body = list_get(bodies, i);
+    bounding_box_t box = body_get_bounding_box(body);
+    assert(isfinite(box.min.x) && isfinite(box.min.y));
+    assert(isfinite(box.max.x) && isfinite(box.max.y));
+    hash->bodies[i] = body;
+    hash->boxes[i] = box;
+    // the coordinates are clamped, so these can't overflow
+    uint64_t width = (uint64_t)(cell_coordinate(hash, box.max.x) -
+                                cell_coordinate(hash, box.min.x)) + 1;
+    uint64_t height = (uint64_t)(cell_coordinate(hash, box.max.y) -
+                                 cell_coordinate(hash, box.min.y)) + 1;
+    if (width > SPATIAL_HASH_MAX_BODY_CELLS ||
+        height > SPATIAL_HASH_MAX_BODY_CELLS ||
+        width * height > SPATIAL_HASH_MAX_BODY_CELLS) {
+      hash->oversized[hash->num_oversized++] = i;
+    } else {
+      num_entries += width * height;
+    }
+  }
+  reserve_entries(hash, num_entries);
+
+  // second pass: add each other body to every cell its box touches
+  hash->num_entries = 0;
+  size_t next_oversized = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    if (next_oversized < hash->num_oversized &&
+        hash->oversized[next_oversized] == i) {
+      next_oversized++;
+      continue;
+    }
+    bounding_box_t box = hash->boxes[i];
+    int64_t min_x = cell_coordinate(hash, box.min.x);
+    int64_t max_x = cell_coordinate(hash, box.max.x);
+    int64_t min_y = cell_coordinate(hash, box.min.y);
+    int64_t max_y = cell_coordinate(hash, box.max.y);
+    for (int64_t x = min_x; x <= max_x; x++) {
+      for (int64_t y = min_y; y <= max_y; y++) {
+        size_t bucket = cell_bucket(hash, x, y);
+        cell_entry_t *entry = &hash->entries[hash->num_entries];
+        entry->cell_x = x;
+        entry->cell_y = y;
+        entry->body_index = i;
+        entry->next = hash->buckets[bucket];
+        hash->buckets[bucket] = hash->num_entries;
+        hash->num_entries++;
+      }
+    }
+  }
+}
+
+// reports an oversized body's pairs with every body after it in the list,
+// and with the bodies before it that aren't oversized, whose pairs with it
+// aren't reported from the grid
+void query_oversized_pairs(spatial_hash_t *hash, size_t oversized,
+                           collision_handler_t handler, void *aux) {
+  size_t index = hash->oversized[oversized];
+  bounding_box_t box = hash->boxes[index];
+  size_t earlier_oversized = 0;
+  for (size_t i = 0; i < hash->num_bodies; i++) {
+    if (i < index && earlier_oversized < oversized &&
+        hash->oversized[earlier_oversized] == i) {
+      earlier_oversized++;
+      continue;
+    }
+    if (i == index || !bounding_box_overlaps(box, hash->boxes[i])) {
+      continue;
+    }
+    if (i < index) {
+      handler(hash->bodies[i], hash->bodies[index], aux);
+    } else {
+      handler(hash->bodies[index], hash->bodies[i], aux);
+    }
+  }
+}
+
+void spatial_hash_query_pairs(spatial_hash_t *hash, collision_handler_t handler,
+                              void *aux) {
+  for (size_t i = 0; i < hash->num_oversized; i++) {
+    query_oversized_pairs(hash, i, handler, aux);
+  }
+  for (size_t bucket = 0; bucket < hash->num_buckets; bucket++) {
+    for (size_t i = hash->buckets[bucket]; i != NO_ENTRY;
+         i = hash->entries[i].next) {
+      cell_entry_t *entry1 = &hash->entries[i];
+      for (size_t j = entry1->next; j != NO_ENTRY; j = hash->entries[j].next) {
+        cell_entry_t *entry2 = &hash->entries[j];
+        // different cells can share a bucket
+        if (entry1->cell_x != entry2->cell_x ||
+            entry1->cell_y != entry2->cell_y) {
+          continue;
+        }
+        size_t index1 = entry1->body_index;
+        size_t index2 = entry2->body_index;
+        if (index1 > index2) {
+          size_t temp = index1;
+          index1 = index2;
+          index2 = temp;
+        }
+        bounding_box_t box1 = hash->boxes[index1];
+        bounding_box_t box2 = hash->boxes[index2];
+        if (!bounding_box_overlaps(box1, box2)) {
+          continue;
+        }
+        // two bodies can share several cells, so only report the pair from
+        // the cell containing the corner of their overlap
+        if (entry1->cell_x !=
+                cell_coordinate(hash, fmax(box1.min.x, box2.min.x)) ||
+            entry1->cell_y !=
+                cell_coordinate(hash, fmax(box1.min.y, box2.min.y))) {
+          continue;
+        }
+        handler(hash->bodies[index1], hash->bodies[index2], aux);
+      }
+    }
+  }
+}
@@ -0,0 +1,448 @@
+#include "thread_pool.h"
+#include "pool.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// the most jobs a thread's queue holds. A thread whose queue is full runs
+// the job itself instead. A power of 2, so indices wrap with a mask
+#define THREAD_POOL_QUEUE_SIZE 1024
+// the size of a cache line, so threads don't write to each other's lines
+#define THREAD_POOL_CACHE_LINE 64
+// with an automatic grain, each thread gets about this many ranges of a loop,
+// so a thread that finishes early can take over work from one that is slow
+const size_t THREAD_POOL_RANGES_PER_THREAD = 4;
+// the initial number of dependents a job has room for
+const size_t THREAD_POOL_INITIAL_DEPENDENTS = 4;
+
+typedef struct thread_job {
+  // a job runs either job(aux) or task(aux, start, end)
+  thread_pool_job_t job;
+  thread_pool_task_t task;
+  void *aux;
+  size_t start;
+  size_t end;
+  // the number of prerequisites that haven't finished yet
+  atomic_size_t prerequisites;
+  // the jobs waiting for this one
+  thread_job_t **dependents;
+  size_t num_dependents;
+  size_t dependents_capacity;
+} thread_job_t;
+
+typedef struct thread_pool thread_pool_t;
+
+// a thread's queue of ready jobs, as a Chase-Lev deque: the thread pushes
+// and takes jobs at the bottom, and other threads steal them from the top.
+// Only stealing the last job needs a compare-and-swap; nothing takes a lock
+typedef struct worker {
+  // top is written by thieves and bottom by the owner, so they are kept on
+  // different cache lines
+  alignas(THREAD_POOL_CACHE_LINE) atomic_llong top;
+  alignas(THREAD_POOL_CACHE_LINE) atomic_llong bottom;
+  _Atomic(thread_job_t *) jobs[THREAD_POOL_QUEUE_SIZE];
+  // only written by the thread itself
+  thread_pool_stats_t stats;
+  thread_pool_t *pool;
+  size_t index;
+} worker_t;
+
+typedef struct thread_pool {
+  // workers[0] belongs to the thread that starts the work
+  size_t num_threads;
+  worker_t *workers;
+  // the number of jobs started and not yet finished; threads keep looking
+  // for work while it is positive
+  atomic_size_t unfinished;
+  // whether work is running, to catch nested loops
+  bool running;
+  // the jobs added since the last thread_pool_run()
+  pool_t *job_pool;
+  thread_job_t **added_jobs;
+  size_t num_added_jobs;
+  size_t added_jobs_capacity;
+  // the ranges of the current loop, reused by the next loop
+  thread_job_t *loop_jobs;
+  size_t loop_jobs_capacity;
+#ifndef __EMSCRIPTEN__
+  pthread_t *threads;
+  // guards round and stopping
+  pthread_mutex_t lock;
+  // signalled when work starts or the pool is stopping
+  pthread_cond_t work_started;
+  // bumped whenever work starts, so sleeping threads can tell it is new
+  size_t round;
+  bool stopping;
+#endif
+} thread_pool_t;
+
+double thread_pool_now() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// adds a job to the bottom of a thread's queue, unless the queue is full.
+// Only called by the queue's own thread
+bool queue_push(worker_t *worker, thread_job_t *job) {
+  long long bottom = atomic_load_explicit(&worker->bottom, memory_order_relaxed);
+  long long top = atomic_load_explicit(&worker->top, memory_order_acquire);
+  if (bottom - top >= THREAD_POOL_QUEUE_SIZE) {
+    return false;
+  }
+  atomic_store_explicit(&worker->jobs[bottom & (THREAD_POOL_QUEUE_SIZE - 1)],
+                        job, memory_order_release);
+  atomic_store_explicit(&worker->bottom, bottom + 1, memory_order_release);
+  return true;
+}
+
+// removes the job at the bottom of a thread's queue, or returns NULL if
+// there is none. Only called by the queue's own thread
+thread_job_t *queue_take(worker_t *worker) {
+  long long bottom =
+      atomic_load_explicit(&worker->bottom, memory_order_relaxed) - 1;
+  atomic_store_explicit(&worker->bottom, bottom, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  long long top = atomic_load_explicit(&worker->top, memory_order_relaxed);
+  if (top > bottom) {
+    // the queue was empty
+    atomic_store_explicit(&worker->bottom, bottom + 1, memory_order_relaxed);
+    return NULL;
+  }
+  thread_job_t *job = atomic_load_explicit(
+      &worker->jobs[bottom & (THREAD_POOL_QUEUE_SIZE - 1)],
+      memory_order_acquire);
+  if (top == bottom) {
+    // the last job, which a thief may be stealing at the same time
+    if (!atomic_compare_exchange_strong_explicit(&worker->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+      job = NULL;
+    }
+    atomic_store_explicit(&worker->bottom, bottom + 1, memory_order_relaxed);
+  }
+  return job;
+}
+
+// removes the job at the top of another thread's queue, or returns NULL if
+// there is none or another thread got it first
+thread_job_t *queue_steal(worker_t *worker) {
+  long long top = atomic_load_explicit(&worker->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  long long bottom = atomic_load_explicit(&worker->bottom, memory_order_acquire);
+  if (top >= bottom) {
+    return NULL;
+  }
+  thread_job_t *job = atomic_load_explicit(
+      &worker->jobs[top & (THREAD_POOL_QUEUE_SIZE - 1)], memory_order_acquire);
+  if (!atomic_compare_exchange_strong_explicit(&worker->top, &top, top + 1,
+                                               memory_order_seq_cst,
+                                               memory_order_relaxed)) {
+    return NULL;
+  }
+  return job;
+}
+
+void thread_pool_execute(worker_t *worker, thread_job_t *job);
+
+// makes a job ready to run on a thread
+void thread_pool_schedule(worker_t *worker, thread_job_t *job) {
+  if (!queue_push(worker, job)) {
+    thread_pool_execute(worker, job);
+  }
+}
+
+void thread_pool_execute(worker_t *worker, thread_job_t *job) {
+  double start = thread_pool_now();
+  if (job->job != NULL) {
+    job->job(job->aux);
+  } else {
+    job->task(job->aux, job->start, job->end);
+  }
+  worker->stats.busy_seconds += thread_pool_now() - start;
+  worker->stats.tasks_run++;
+  for (size_t i = 0; i < job->num_dependents; i++) {
+    thread_job_t *dependent = job->dependents[i];
+    // whoever finishes the last prerequisite starts the dependent
+    if (atomic_fetch_sub(&dependent->prerequisites, 1) == 1) {
+      thread_pool_schedule(worker, dependent);
+    }
+  }
+  // this must come last: once it reaches 0, the caller may free the job
+  atomic_fetch_sub(&worker->pool->unfinished, 1);
+}
+
+// takes a job from the thread's own queue, or else steals one
+thread_job_t *thread_pool_find_job(worker_t *worker) {
+  thread_job_t *job = queue_take(worker);
+  if (job != NULL) {
+    return job;
+  }
+  thread_pool_t *pool = worker->pool;
+  for (size_t i = 1; i < pool->num_threads; i++) {
+    worker_t *victim = &pool->workers[(worker->index + i) % pool->num_threads];
+    job = queue_steal(victim);
+    if (job != NULL) {
+      worker->stats.tasks_stolen++;
+      return job;
+    }
+  }
+  return NULL;
+}
+
+// runs and steals jobs until all the started work is done
+void thread_pool_work(worker_t *worker) {
+  while (atomic_load(&worker->pool->unfinished) > 0) {
+    thread_job_t *job = thread_pool_find_job(worker);
+    if (job != NULL) {
+      thread_pool_execute(worker, job);
+    } else {
+#ifndef __EMSCRIPTEN__
+      // the remaining jobs are running elsewhere or waiting for them
+      sched_yield();
+#endif
+    }
+  }
+}
+
+#ifndef __EMSCRIPTEN__
+void *thread_pool_thread(void *arg) {
+  worker_t *worker = arg;
+  thread_pool_t *pool = worker->pool;
+  size_t last_round = 0;
+  pthread_mutex_lock(&pool->lock);
+  while (true) {
+    while (pool->round == last_round && !pool->stopping) {
+      pthread_cond_wait(&pool->work_started, &pool->lock);
+    }
+    if (pool->stopping) {
+      break;
+    }
+    last_round = pool->round;
+    pthread_mutex_unlock(&pool->lock);
+    thread_pool_work(worker);
+    pthread_mutex_lock(&pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+#endif
+
+// wakes the other threads to help with unfinished work
+void thread_pool_wake(thread_pool_t *pool) {
+#ifndef __EMSCRIPTEN__
+  if (pool->num_threads > 1) {
+    pthread_mutex_lock(&pool->lock);
+    pool->round++;
+    pthread_cond_broadcast(&pool->work_started);
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+}
+
+thread_pool_t *thread_pool_init(size_t num_threads) {
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  assert(pool != NULL);
+#ifdef __EMSCRIPTEN__
+  pool->num_threads = 1;
+#else
+  pool->num_threads = num_threads > 1 ? num_threads : 1;
+#endif
+  // aligned_alloc() needs a multiple of the alignment, which worker_t is
+  pool->workers = aligned_alloc(alignof(worker_t),
+                                sizeof(worker_t) * pool->num_threads);
+  assert(pool->workers != NULL);
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    worker_t *worker = &pool->workers[i];
+    atomic_init(&worker->top, 0);
+    atomic_init(&worker->bottom, 0);
+    for (size_t j = 0; j < THREAD_POOL_QUEUE_SIZE; j++) {
+      atomic_init(&worker->jobs[j], NULL);
+    }
+    worker->stats = (thread_pool_stats_t){0};
+    worker->pool = pool;
+    worker->index = i;
+  }
+  atomic_init(&pool->unfinished, 0);
+  pool->running = false;
+  pool->job_pool = pool_init(sizeof(thread_job_t));
+  pool->added_jobs = NULL;
+  pool->num_added_jobs = 0;
+  pool->added_jobs_capacity = 0;
+  pool->loop_jobs = NULL;
+  pool->loop_jobs_capacity = 0;
+#ifndef __EMSCRIPTEN__
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->work_started, NULL);
+  pool->round = 0;
+  pool->stopping = false;
+  // thread 0 is the caller's
+  pool->threads = malloc(sizeof(pthread_t) * pool->num_threads);
+  assert(pool->threads != NULL);
+  for (size_t i = 1; i < pool->num_threads; i++) {
+    int result = pthread_create(&pool->threads[i], NULL, thread_pool_thread,
+                                &pool->workers[i]);
+    assert(result == 0);
+  }
+#endif
+  return pool;
+}
+
+void free_job(thread_pool_t *pool, thread_job_t *job) {
+  free(job->dependents);
+  pool_release(pool->job_pool, job);
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+  assert(!pool->running);
+#ifndef __EMSCRIPTEN__
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->work_started);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 1; i < pool->num_threads; i++) {
+    pthread_join(pool->threads[i], NULL);
+  }
+  free(pool->threads);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->work_started);
+#endif
+  for (size_t i = 0; i < pool->num_added_jobs; i++) {
+    free_job(pool, pool->added_jobs[i]);
+  }
+  free(pool->added_jobs);
+  pool_free(pool->job_pool);
+  free(pool->loop_jobs);
+  free(pool->workers);
+  free(pool);
+}
+
+size_t thread_pool_threads(thread_pool_t *pool) { return pool->num_threads; }
+
+void thread_pool_for(thread_pool_t *pool, size_t count, size_t grain,
+                     thread_pool_task_t task, void *aux) {
+  assert(!pool->running);
+  if (count == 0) {
+    return;
+  }
+  if (grain == 0) {
+    size_t num_ranges = pool->num_threads * THREAD_POOL_RANGES_PER_THREAD;
+    grain = (count + num_ranges - 1) / num_ranges;
+  }
+  size_t num_ranges = (count + grain - 1) / grain;
+  if (num_ranges > pool->loop_jobs_capacity) {
+    free(pool->loop_jobs);
+    pool->loop_jobs = malloc(sizeof(thread_job_t) * num_ranges);
+    assert(pool->loop_jobs != NULL);
+    pool->loop_jobs_capacity = num_ranges;
+  }
+  pool->running = true;
+  atomic_store(&pool->unfinished, num_ranges);
+  thread_pool_wake(pool);
+  // the other threads steal ranges while the rest are being pushed
+  worker_t *worker = &pool->workers[0];
+  for (size_t i = 0; i < num_ranges; i++) {
+    thread_job_t *job = &pool->loop_jobs[i];
+    job->job = NULL;
+    job->task = task;
+    job->aux = aux;
+    job->start = i * grain;
+    job->end = count - job->start < grain ? count : job->start + grain;
+    job->num_dependents = 0;
+    thread_pool_schedule(worker, job);
+  }
+  thread_pool_work(worker);
+  pool->running = false;
+}
+
+thread_job_t *thread_pool_add_job(thread_pool_t *pool, thread_pool_job_t job,
+                                  void *aux) {
+  assert(!pool->running);
+  assert(job != NULL);
+  thread_job_t *added = pool_alloc(pool->job_pool);
+  added->job = job;
+  added->task = NULL;
+  added->aux = aux;
+  atomic_init(&added->prerequisites, 0);
+  added->dependents = NULL;
+  added->num_dependents = 0;
+  added->dependents_capacity = 0;
+  if (pool->num_added_jobs == pool->added_jobs_capacity) {
+    size_t capacity =
+        pool->added_jobs_capacity == 0 ? 16 : pool->added_jobs_capacity * 2;
+    pool->added_jobs =
+        realloc(pool->added_jobs, sizeof(thread_job_t *) * capacity);
+    assert(pool->added_jobs != NULL);
+    pool->added_jobs_capacity = capacity;
+  }
+  pool->added_jobs[pool->num_added_jobs++] = added;
+  return added;
+}
+
+void thread_pool_add_dependency(thread_job_t *job, thread_job_t *prerequisite) {
+  assert(job != prerequisite);
+  if (prerequisite->num_dependents == prerequisite->dependents_capacity) {
+    size_t capacity = prerequisite->dependents_capacity == 0
+                          ? THREAD_POOL_INITIAL_DEPENDENTS
+                          : prerequisite->dependents_capacity * 2;
+    prerequisite->dependents = realloc(prerequisite->dependents,
+                                       sizeof(thread_job_t *) * capacity);
+    assert(prerequisite->dependents != NULL);
+    prerequisite->dependents_capacity = capacity;
+  }
+  prerequisite->dependents[prerequisite->num_dependents++] = job;
+  atomic_fetch_add(&job->prerequisites, 1);
+}
+
+void thread_pool_run(thread_pool_t *pool) {
+  assert(!pool->running);
+  size_t num_jobs = pool->num_added_jobs;
+  if (num_jobs == 0) {
+    return;
+  }
+  // find the jobs that can start before any of them runs, since a running
+  // job starts its dependents itself
+  thread_job_t **ready = malloc(sizeof(thread_job_t *) * num_jobs);
+  assert(ready != NULL);
+  size_t num_ready = 0;
+  for (size_t i = 0; i < num_jobs; i++) {
+    thread_job_t *job = pool->added_jobs[i];
+    if (atomic_load(&job->prerequisites) == 0) {
+      ready[num_ready++] = job;
+    }
+  }
+  assert(num_ready > 0);
+  pool->running = true;
+  atomic_store(&pool->unfinished, num_jobs);
+  thread_pool_wake(pool);
+  worker_t *worker = &pool->workers[0];
+  for (size_t i = 0; i < num_ready; i++) {
+    thread_pool_schedule(worker, ready[i]);
+  }
+  free(ready);
+  thread_pool_work(worker);
+  for (size_t i = 0; i < num_jobs; i++) {
+    free_job(pool, pool->added_jobs[i]);
+  }
+  pool->num_added_jobs = 0;
+  pool->running = false;
+}
+
+thread_pool_stats_t thread_pool_get_stats(thread_pool_t *pool, size_t thread) {
+  assert(thread < pool->num_threads);
+  return pool->workers[thread].stats;
+}
+
+void thread_pool_reset_stats(thread_pool_t *pool) {
+  assert(!pool->running);
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    pool->workers[i].stats = (thread_pool_stats_t){0};
+  }
+}
@@ -7,6 +7,8 @@
 
 const vector_t VEC_ZERO = (vector_t){.x = 0.0, .y = 0.0};
 
+const rotation_t ROTATION_IDENTITY = {.cos_angle = 1.0, .sin_angle = 0.0};
+
 vector_t vec_add(vector_t v1, vector_t v2) {
   vector_t ret = {.x = v1.x + v2.x, .y = v1.y + v2.y};
   return ret;
@@ -42,7 +44,16 @@ double vec_cross(vector_t v1, vector_t v2) {
 }
 
 vector_t vec_rotate(vector_t v, double angle) {
-  vector_t ret = {.x = (cos(angle) * v.x) - (sin(angle) * v.y),
-                  .y = (sin(angle) * v.x) + (cos(angle) * v.y)};
+  return vec_rotate_by(v, rotation_from_angle(angle));
+}
+
+rotation_t rotation_from_angle(double angle) {
+  rotation_t ret = {.cos_angle = cos(angle), .sin_angle = sin(angle)};
+  return ret;
+}
+
+vector_t vec_rotate_by(vector_t v, rotation_t rotation) {
+  vector_t ret = {.x = (rotation.cos_angle * v.x) - (rotation.sin_angle * v.y),
+                  .y = (rotation.sin_angle * v.x) + (rotation.cos_angle * v.y)};
   return ret;
 }
@@ -0,0 +1,253 @@
+#include "aabb_tree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double TREE_MARGIN = 0.5;
+
+// Makes a body that is a w x h rectangle centered at the given point
+body_t *make_rectangle(vector_t center, double w, double h) {
+  list_t *shape = list_init(4, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){center.x - w / 2, center.y - h / 2};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){center.x + w / 2, center.y - h / 2};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){center.x + w / 2, center.y + h / 2};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){center.x - w / 2, center.y + h / 2};
+  list_add(shape, v);
+  return body_init(shape, 1, (rgb_color_t){0, 0, 0});
+}
+
+// Makes bodies whose sizes vary by two orders of magnitude
+list_t *make_random_bodies(size_t count) {
+  list_t *bodies = list_init(count, (free_func_t)body_free);
+  for (size_t i = 0; i < count; i++) {
+    vector_t center = {rand() % 400 - 200, rand() % 400 - 200};
+    double size = i % 10 == 0 ? 40 + rand() % 40 : 0.4 + rand() % 4;
+    list_add(bodies, make_rectangle(center, size, size * 3));
+  }
+  return bodies;
+}
+
+size_t index_of(list_t *bodies, body_t *body) {
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    if (list_get(bodies, i) == body) {
+      return i;
+    }
+  }
+  assert(false);
+  return 0;
+}
+
+typedef struct {
+  list_t *bodies;
+  size_t *counts;
+} pair_counts_t;
+
+void count_pair(body_t *body1, body_t *body2, void *aux) {
+  pair_counts_t *counts = aux;
+  size_t i = index_of(counts->bodies, body1);
+  size_t j = index_of(counts->bodies, body2);
+  // bodies were added in list order
+  assert(i < j);
+  counts->counts[i * list_size(counts->bodies) + j]++;
+}
+
+bounding_box_t grow(bounding_box_t box, double amount) {
+  return (bounding_box_t){{box.min.x - amount, box.min.y - amount},
+                          {box.max.x + amount, box.max.y + amount}};
+}
+
+// Checks that every overlapping pair is reported exactly once,
+// and that only pairs within the fat margin are reported
+void check_pairs(aabb_tree_t *tree, list_t *bodies) {
+  size_t n = list_size(bodies);
+  pair_counts_t counts = {.bodies = bodies,
+                          .counts = calloc(n * n, sizeof(size_t))};
+  aabb_tree_query_pairs(tree, count_pair, &counts);
+  for (size_t i = 0; i < n; i++) {
+    bounding_box_t box1 = body_get_bounding_box(list_get(bodies, i));
+    for (size_t j = i + 1; j < n; j++) {
+      bounding_box_t box2 = body_get_bounding_box(list_get(bodies, j));
+      size_t count = counts.counts[i * n + j];
+      assert(count <= 1);
+      if (bounding_box_overlaps(box1, box2)) {
+        assert(count == 1);
+      }
+      if (count == 1) {
+        // fat boxes may have been computed before the bodies moved
+        // by at most TREE_MARGIN, so they grow by at most 2 * TREE_MARGIN
+        assert(bounding_box_overlaps(grow(box1, 4 * TREE_MARGIN), box2));
+      }
+    }
+  }
+  free(counts.counts);
+}
+
+void test_empty_tree() {
+  aabb_tree_t *tree = aabb_tree_init(TREE_MARGIN);
+  assert(aabb_tree_size(tree) == 0);
+  assert(aabb_tree_height(tree) == 0);
+  list_t *bodies = list_init(0, NULL);
+  check_pairs(tree, bodies);
+  list_free(bodies);
+  aabb_tree_free(tree);
+}
+
+void test_tree_pairs() {
+  const size_t NUM_BODIES = 500;
+  srand(7);
+  list_t *bodies = make_random_bodies(NUM_BODIES);
+  aabb_tree_t *tree = aabb_tree_init(TREE_MARGIN);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    assert(aabb_tree_update(tree, list_get(bodies, i)));
+  }
+  assert(aabb_tree_size(tree) == NUM_BODIES);
+  // rotations keep the tree close to balanced
+  assert(aabb_tree_height(tree) < 4 * log2(NUM_BODIES));
+  check_pairs(tree, bodies);
+  aabb_tree_free(tree);
+  list_free(bodies);
+}
+
+void test_tree_update() {
+  aabb_tree_t *tree = aabb_tree_init(TREE_MARGIN);
+  body_t *body = make_rectangle((vector_t){0, 0}, 2, 2);
+  assert(aabb_tree_update(tree, body));
+  // small moves stay inside the fat box
+  body_translate(body, (vector_t){TREE_MARGIN / 2, -TREE_MARGIN / 2});
+  assert(!aabb_tree_update(tree, body));
+  body_translate(body, (vector_t){TREE_MARGIN, 0});
+  assert(aabb_tree_update(tree, body));
+  assert(aabb_tree_size(tree) == 1);
+  aabb_tree_remove(tree, body);
+  assert(aabb_tree_size(tree) == 0);
+  // removing a body that is not in the tree does nothing
+  aabb_tree_remove(tree, body);
+  assert(aabb_tree_size(tree) == 0);
+  aabb_tree_free(tree);
+  body_free(body);
+}
+
+void test_tree_moving_bodies() {
+  const size_t NUM_BODIES = 300;
+  srand(11);
+  list_t *bodies = make_random_bodies(NUM_BODIES);
+  aabb_tree_t *tree = aabb_tree_init(TREE_MARGIN);
+  for (int step = 0; step < 20; step++) {
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      body_t *body = list_get(bodies, i);
+      vector_t move = {(rand() % 100 - 50) / 100.0,
+                       (rand() % 100 - 50) / 100.0};
+      body_translate(body, move);
+      aabb_tree_update(tree, body);
+    }
+    check_pairs(tree, bodies);
+  }
+  // remove every other body and check the rest are still found
+  list_t *remaining = list_init(NUM_BODIES, NULL);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    if (i % 2 == 0) {
+      aabb_tree_remove(tree, list_get(bodies, i));
+    } else {
+      list_add(remaining, list_get(bodies, i));
+    }
+  }
+  assert(aabb_tree_size(tree) == NUM_BODIES / 2);
+  check_pairs(tree, remaining);
+  list_free(remaining);
+  aabb_tree_free(tree);
+  list_free(bodies);
+}
+
+typedef struct {
+  list_t *bodies;
+  bool *found;
+} found_t;
+
+void mark_found(body_t *body, void *aux) {
+  found_t *found = aux;
+  size_t i = index_of(found->bodies, body);
+  assert(!found->found[i]);
+  found->found[i] = true;
+}
+
+void test_tree_queries() {
+  const size_t NUM_BODIES = 400;
+  srand(13);
+  list_t *bodies = make_random_bodies(NUM_BODIES);
+  aabb_tree_t *tree = aabb_tree_init(TREE_MARGIN);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    aabb_tree_update(tree, list_get(bodies, i));
+  }
+  found_t found = {.bodies = bodies, .found = malloc(NUM_BODIES)};
+  for (int query = 0; query < 50; query++) {
+    vector_t start = {rand() % 400 - 200, rand() % 400 - 200};
+    vector_t end = {rand() % 400 - 200, rand() % 400 - 200};
+    bounding_box_t box = {{fmin(start.x, end.x), fmin(start.y, end.y)},
+                          {fmax(start.x, end.x), fmax(start.y, end.y)}};
+
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      found.found[i] = false;
+    }
+    aabb_tree_query_box(tree, box, mark_found, &found);
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      bounding_box_t body_box = body_get_bounding_box(list_get(bodies, i));
+      assert(found.found[i] == bounding_box_overlaps(body_box, box));
+    }
+
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      found.found[i] = false;
+    }
+    aabb_tree_query_ray(tree, start, end, mark_found, &found);
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+      bounding_box_t body_box = body_get_bounding_box(list_get(bodies, i));
+      assert(found.found[i] ==
+             bounding_box_intersects_segment(body_box, start, end));
+    }
+  }
+  free(found.found);
+  aabb_tree_free(tree);
+  list_free(bodies);
+}
+
+void test_segment_intersection() {
+  bounding_box_t box = {{0, 0}, {2, 1}};
+  assert(bounding_box_intersects_segment(box, (vector_t){-1, 0.5},
+                                         (vector_t){3, 0.5}));
+  assert(bounding_box_intersects_segment(box, (vector_t){1, 0.5},
+                                         (vector_t){1, 0.6}));
+  assert(bounding_box_intersects_segment(box, (vector_t){-1, -1},
+                                         (vector_t){3, 2}));
+  assert(!bounding_box_intersects_segment(box, (vector_t){-1, 0.5},
+                                          (vector_t){-0.5, 0.5}));
+  assert(!bounding_box_intersects_segment(box, (vector_t){-1, 1},
+                                          (vector_t){1, 3}));
+  assert(!bounding_box_intersects_segment(box, (vector_t){3, -1},
+                                          (vector_t){3, 2}));
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_tree)
+  DO_TEST(test_tree_pairs)
+  DO_TEST(test_tree_update)
+  DO_TEST(test_tree_moving_bodies)
+  DO_TEST(test_tree_queries)
+  DO_TEST(test_segment_intersection)
+
+  puts("aabb_tree_test PASS");
+}
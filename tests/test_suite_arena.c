@@ -0,0 +1,72 @@
+#include "arena.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_arena_alloc() {
+  arena_t *arena = arena_init(1024);
+  assert(arena_used(arena) == 0);
+  char *a = arena_alloc(arena, 3);
+  double *b = arena_alloc(arena, sizeof(double) * 10);
+  assert((uintptr_t)a % alignof(max_align_t) == 0);
+  assert((uintptr_t)b % alignof(max_align_t) == 0);
+  memset(a, 'a', 3);
+  for (size_t i = 0; i < 10; i++) {
+    b[i] = i;
+  }
+  assert(a[2] == 'a' && b[9] == 9);
+  assert(arena_used(arena) >= 3 + sizeof(double) * 10);
+  arena_reset(arena);
+  assert(arena_used(arena) == 0);
+  // the memory is reused after a reset
+  assert(arena_alloc(arena, 3) == a);
+  arena_free(arena);
+}
+
+void test_arena_overflow() {
+  arena_t *arena = arena_init(64);
+  // far more than the initial capacity, all valid at once
+  const size_t N = 100;
+  size_t **blocks = malloc(sizeof(size_t *) * N);
+  for (size_t i = 0; i < N; i++) {
+    blocks[i] = arena_alloc(arena, sizeof(size_t) * (i + 1));
+    for (size_t j = 0; j <= i; j++) {
+      blocks[i][j] = i;
+    }
+  }
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j <= i; j++) {
+      assert(blocks[i][j] == i);
+    }
+  }
+  size_t used = arena_used(arena);
+  // after a reset, the same allocations fit in one block
+  arena_reset(arena);
+  char *first = arena_alloc(arena, sizeof(size_t));
+  for (size_t i = 1; i < N; i++) {
+    char *block = arena_alloc(arena, sizeof(size_t) * (i + 1));
+    assert(block > first && block < first + used);
+  }
+  assert(arena_used(arena) == used);
+  free(blocks);
+  arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_arena_alloc)
+  DO_TEST(test_arena_overflow)
+
+  puts("arena_test PASS");
+}
@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "body.h"
 #include "test_util.h"
 #include <assert.h>
@@ -241,6 +242,85 @@ void test_body_info_freer() {
     body_free(body);
 }
 
+// Shapes are kept in local coordinates, so spinning a body many times
+// and moving it back must not distort it
+void test_body_no_drift() {
+    vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+    const size_t VERTICES = sizeof(v) / sizeof(*v);
+    list_t *shape = list_init(0, free);
+    for (size_t i = 0; i < VERTICES; i++) {
+        vector_t *list_v = malloc(sizeof(*list_v));
+        *list_v = v[i];
+        list_add(shape, list_v);
+    }
+    body_t *body = body_init(shape, 1, (rgb_color_t) {0, 0, 0});
+    body_set_velocity(body, (vector_t) {3, -1});
+    body_set_rotational_velocity(body, 2 * M_PI / 1000);
+    for (int i = 0; i < 1000; i++) {
+        body_tick(body, 0.01);
+        // looking at the shape mid-spin must not change the result
+        if (i % 100 == 0) {
+            list_free(body_get_shape(body));
+        }
+    }
+    body_set_rotation(body, 0);
+    body_set_centroid(body, (vector_t) {1.5, 1.5});
+    list_t *shape2 = body_get_shape(body);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_isclose(*(vector_t *) list_get(shape2, i), v[i]));
+    }
+    list_free(shape2);
+    body_free(body);
+}
+
+void test_body_interpolation() {
+    vector_t v[] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+    const size_t VERTICES = sizeof(v) / sizeof(*v);
+    list_t *shape = list_init(0, free);
+    for (size_t i = 0; i < VERTICES; i++) {
+        vector_t *list_v = malloc(sizeof(*list_v));
+        *list_v = v[i];
+        list_add(shape, list_v);
+    }
+    body_t *body = body_init(shape, 1, (rgb_color_t) {0, 0, 0});
+    // a new body starts with its initial transform saved
+    assert(vec_equal(body_get_previous_centroid(body), VEC_ZERO));
+    assert(body_get_previous_rotation(body) == 0);
+    body_save_transform(body);
+    body_set_centroid(body, (vector_t) {4, 2});
+    body_set_rotation(body, M_PI / 2);
+    assert(body_get_rotation(body) == M_PI / 2);
+    assert(vec_equal(body_get_previous_centroid(body), VEC_ZERO));
+
+    arena_t *arena = arena_init(1024);
+    // halfway there, the square is turned by 45 degrees
+    polygon_t *halfway = body_get_interpolated_shape_in_arena(body, 0.5, arena);
+    assert(halfway->size == VERTICES);
+    assert(vec_isclose(polygon_get_vertex(halfway, 0),
+                       (vector_t) {2, 1 - sqrt(2)}));
+    assert(vec_isclose(polygon_compute_centroid(halfway), (vector_t) {2, 1}));
+    // the ends are the previous and current shapes
+    polygon_t *start = body_get_interpolated_shape_in_arena(body, 0, arena);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_isclose(polygon_get_vertex(start, i), v[i]));
+    }
+    polygon_t *end = body_get_interpolated_shape_in_arena(body, 1, arena);
+    polygon_t *current = body_peek_shape(body);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_isclose(polygon_get_vertex(end, i),
+                           polygon_get_vertex(current, i)));
+    }
+    // once saved, the body is drawn where it is
+    body_save_transform(body);
+    polygon_t *saved = body_get_interpolated_shape_in_arena(body, 0.5, arena);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_equal(polygon_get_vertex(saved, i),
+                         polygon_get_vertex(current, i)));
+    }
+    arena_free(arena);
+    body_free(body);
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -258,6 +338,8 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_body_remove)
     DO_TEST(test_body_info)
     DO_TEST(test_body_info_freer)
+    DO_TEST(test_body_no_drift)
+    DO_TEST(test_body_interpolation)
 
     puts("body_test PASS");
 }
@@ -4,6 +4,78 @@
 #include <math.h>
 #include <stdlib.h>
 
+// Makes a body from a list of vertices
+body_t *make_body(vector_t *vertices, size_t size) {
+  list_t *shape = list_init(size, free);
+  for (size_t i = 0; i < size; i++) {
+    vector_t *v = malloc(sizeof(*v));
+    *v = vertices[i];
+    list_add(shape, v);
+  }
+  return body_init(shape, 1, (rgb_color_t){0, 0, 0});
+}
+
+// Checks that the cached bounding box matches the body's current shape
+void check_bounding_box(body_t *body) {
+  list_t *shape = body_get_shape(body);
+  bounding_box_t expected = polygon_bounding_box(shape);
+  bounding_box_t box = body_get_bounding_box(body);
+  assert(vec_isclose(box.min, expected.min));
+  assert(vec_isclose(box.max, expected.max));
+  list_free(shape);
+}
+
+void test_cached_bounding_box() {
+  vector_t vertices[] = {{0, 0}, {4, 0}, {4, 1}, {0, 1}};
+  body_t *body = make_body(vertices, 4);
+  check_bounding_box(body);
+  body_set_centroid(body, (vector_t){-10, 3});
+  check_bounding_box(body);
+  body_set_rotation(body, M_PI / 6);
+  check_bounding_box(body);
+  body_set_velocity(body, (vector_t){2, -1});
+  body_set_rotational_velocity(body, 0.3);
+  for (int i = 0; i < 10; i++) {
+    body_tick(body, 0.5);
+    check_bounding_box(body);
+  }
+  body_free(body);
+}
+
+void test_find_body_collision() {
+  vector_t square[] = {{0, 0}, {2, 0}, {2, 2}, {0, 2}};
+  vector_t overlapping[] = {{1, 1}, {3, 1}, {3, 3}, {1, 3}};
+  vector_t far[] = {{10, 10}, {12, 10}, {12, 12}, {10, 12}};
+  // bounding boxes overlap, but the triangle is past the square's corner
+  vector_t triangle[] = {{2.5, 1.9}, {1.9, 2.5}, {3, 3}};
+  body_t *body = make_body(square, 4);
+  body_t *overlapping_body = make_body(overlapping, 4);
+  body_t *far_body = make_body(far, 4);
+  body_t *triangle_body = make_body(triangle, 3);
+  body_set_rotation(body, M_PI / 4);
+
+  assert(find_body_collision(body, overlapping_body));
+  assert(find_body_collision(overlapping_body, body));
+  assert(!find_body_collision(body, far_body));
+  assert(!find_body_collision(far_body, body));
+  body_set_rotation(body, 0);
+  assert(bounding_box_overlaps(body_get_bounding_box(body),
+                               body_get_bounding_box(triangle_body)));
+  assert(!find_body_collision(body, triangle_body));
+  body_translate(triangle_body, (vector_t){-0.5, -0.5});
+  assert(find_body_collision(body, triangle_body));
+
+  // checking for a collision leaves the shapes untouched
+  polygon_t *shape = body_peek_shape(triangle_body);
+  assert(shape->size == 3);
+  assert(vec_isclose(polygon_get_vertex(shape, 0), (vector_t){2, 1.4}));
+
+  body_free(body);
+  body_free(overlapping_body);
+  body_free(far_body);
+  body_free(triangle_body);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -13,5 +85,8 @@ int main(int argc, char *argv[]) {
     read_testname(argv[1], testname, sizeof(testname));
   }
 
+  DO_TEST(test_cached_bounding_box)
+  DO_TEST(test_find_body_collision)
+
   puts("collision_test PASS");
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "fmm.h"
+#include "forces.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double MIN_PULL_DISTANCE = 5.0;
+
+// Computes the field at every point the slow way, like gravity() does
+vector_t *brute_force_fields(vector_t *positions, double *masses,
+                             size_t count, double min_distance) {
+  vector_t *fields = calloc(count, sizeof(vector_t));
+  for (size_t i = 0; i < count; i++) {
+    for (size_t j = 0; j < count; j++) {
+      double distance = vec_l2norm(positions[i], positions[j]);
+      if (i == j || distance == 0 || distance < min_distance) {
+        continue;
+      }
+      vector_t direction = vec_subtract(positions[j], positions[i]);
+      fields[i] = vec_add(fields[i], vec_multiply(masses[j] / pow(distance, 3),
+                                                  direction));
+    }
+  }
+  return fields;
+}
+
+double norm(vector_t v) { return sqrt(vec_dot(v, v)); }
+
+// Solves for random points and returns the total error of the fields,
+// relative to the total exact field
+double relative_error(size_t count, size_t order, double min_distance) {
+  vector_t *positions = malloc(sizeof(vector_t) * count);
+  double *masses = malloc(sizeof(double) * count);
+  fmm_t *fmm = fmm_init(order);
+  assert(fmm_order(fmm) == order);
+  for (size_t i = 0; i < count; i++) {
+    // clump some of the points together to get an uneven tree
+    double spread = i % 3 == 0 ? 100 : 3000;
+    positions[i] = (vector_t){(double)rand() / RAND_MAX * spread,
+                              (double)rand() / RAND_MAX * spread};
+    masses[i] = 1 + rand() % 100;
+    assert(fmm_add_point(fmm, positions[i], masses[i]) == i);
+  }
+  fmm_solve(fmm, min_distance);
+  vector_t *exact = brute_force_fields(positions, masses, count, min_distance);
+  double total_error = 0;
+  double total_field = 0;
+  for (size_t i = 0; i < count; i++) {
+    total_error += norm(vec_subtract(exact[i], fmm_get_field(fmm, i)));
+    total_field += norm(exact[i]);
+  }
+  free(exact);
+  fmm_free(fmm);
+  free(positions);
+  free(masses);
+  return total_error / total_field;
+}
+
+void test_empty_solver() {
+  fmm_t *fmm = fmm_init(4);
+  fmm_solve(fmm, MIN_PULL_DISTANCE);
+  fmm_free(fmm);
+}
+
+void test_two_points() {
+  fmm_t *fmm = fmm_init(4);
+  fmm_add_point(fmm, (vector_t){0, 0}, 2);
+  fmm_add_point(fmm, (vector_t){30, 40}, 5);
+  fmm_solve(fmm, MIN_PULL_DISTANCE);
+  assert(vec_isclose(fmm_get_field(fmm, 0),
+                     vec_multiply(5.0 / 125000, (vector_t){30, 40})));
+  assert(vec_isclose(fmm_get_field(fmm, 1),
+                     vec_multiply(2.0 / 125000, (vector_t){-30, -40})));
+  // a point added after solving is included in the next solve
+  fmm_add_point(fmm, (vector_t){0, 1}, 1);
+  fmm_solve(fmm, 0);
+  assert(vec_isclose(fmm_get_field(fmm, 2),
+                     vec_add((vector_t){0, -2},
+                             vec_multiply(5.0 / pow(sqrt(2421), 3),
+                                          (vector_t){30, 39}))));
+  fmm_clear(fmm);
+  fmm_solve(fmm, 0);
+  fmm_free(fmm);
+}
+
+// Higher orders must be more accurate
+void test_accuracy() {
+  srand(10);
+  double error2 = relative_error(3000, 2, MIN_PULL_DISTANCE);
+  srand(10);
+  double error4 = relative_error(3000, 4, MIN_PULL_DISTANCE);
+  srand(10);
+  double error8 = relative_error(3000, 8, MIN_PULL_DISTANCE);
+  assert(error4 < error2);
+  assert(error8 < error4);
+  assert(error4 < 3e-3);
+  assert(error8 < 1e-4);
+}
+
+// Pairs closer than the minimum distance must be left out exactly,
+// even when they are in different groups
+void test_min_distance() {
+  srand(11);
+  assert(relative_error(2000, 8, 50) < 1e-4);
+  srand(12);
+  assert(relative_error(2000, 8, 0) < 1e-4);
+}
+
+// Many points at one position can't be split, which must not recurse forever
+void test_coincident_points() {
+  fmm_t *fmm = fmm_init(4);
+  for (size_t i = 0; i < 100; i++) {
+    fmm_add_point(fmm, (vector_t){7, 7}, 1);
+  }
+  fmm_add_point(fmm, (vector_t){17, 7}, 1);
+  fmm_solve(fmm, 0);
+  assert(vec_isclose(fmm_get_field(fmm, 100), (vector_t){-1, 0}));
+  assert(vec_isclose(fmm_get_field(fmm, 0), (vector_t){0.01, 0}));
+  fmm_free(fmm);
+}
+
+list_t *make_shape() {
+  list_t *shape = list_init(3, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){0, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){1, 0};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){0, 1};
+  list_add(shape, v);
+  return shape;
+}
+
+// Tests that FMM gravity in a scene matches per-pair gravity()
+void test_fmm_gravity() {
+  const double G = 100;
+  const size_t NUM_BODIES = 200;
+  scene_t *pairs = scene_init();
+  scene_t *fmm = scene_init();
+  srand(13);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    vector_t position = {rand() % 2000, rand() % 2000};
+    double mass = 1 + rand() % 10;
+    body_t *body1 = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_t *body2 = body_init(make_shape(), mass, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body1, position);
+    body_set_centroid(body2, position);
+    scene_add_body(pairs, body1);
+    scene_add_body(fmm, body2);
+  }
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      create_newtonian_gravity(pairs, G, scene_get_body(pairs, i),
+                               scene_get_body(pairs, j));
+    }
+  }
+  create_fmm_gravity(fmm, G, 10);
+  scene_add_body(fmm, body_init(make_shape(), INFINITY,
+                                (rgb_color_t){0, 0, 0}));
+  for (int i = 0; i < 20; i++) {
+    scene_tick(pairs, 0.1);
+    scene_tick(fmm, 0.1);
+    for (size_t j = 0; j < NUM_BODIES; j++) {
+      vector_t exact = body_get_velocity(scene_get_body(pairs, j));
+      vector_t approximate = body_get_velocity(scene_get_body(fmm, j));
+      // individual fields can be far less accurate than the total
+      assert(norm(vec_subtract(exact, approximate)) <= 1e-3 * norm(exact));
+    }
+  }
+  scene_free(pairs);
+  scene_free(fmm);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_solver)
+  DO_TEST(test_two_points)
+  DO_TEST(test_accuracy)
+  DO_TEST(test_min_distance)
+  DO_TEST(test_coincident_points)
+  DO_TEST(test_fmm_gravity)
+
+  puts("fmm_test PASS");
+}
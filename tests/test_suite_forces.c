@@ -150,6 +150,189 @@ void test_forces_removed() {
   scene_free(scene);
 }
 
+// Tests that forces work on bodies that were never added to the scene,
+// such as a fixed anchor for a spring
+void test_body_outside_scene() {
+  const double K = 2;
+  const double DT = 0.01;
+  scene_t *scene = scene_init();
+  body_t *mass = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(mass, (vector_t){3, 0});
+  scene_add_body(scene, mass);
+  body_t *anchor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  body_t *drifter = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(drifter, (vector_t){1, 0});
+  create_spring(scene, K, mass, anchor);
+  create_drag(scene, 1, drifter);
+  scene_tick(scene, DT);
+  // pulled toward the anchor, which isn't moved by the scene
+  assert(body_get_velocity(mass).x < 0);
+  assert(vec_equal(body_get_centroid(anchor), VEC_ZERO));
+  // the drag is applied, but the scene never ticks the body
+  assert(body_get_force(drifter).x < 0);
+  assert(vec_equal(body_get_velocity(drifter), (vector_t){1, 0}));
+  // removing the body in the scene stops the spring
+  scene_remove_body(scene, 0);
+  scene_tick(scene, DT);
+  scene_tick(scene, DT);
+  assert(scene_bodies(scene) == 0);
+  scene_free(scene);
+  body_free(anchor);
+  body_free(drifter);
+}
+
+// Tests that a force built from aux_init() and added to a scene by hand
+// acts the same as one from create_spring()
+void test_aux_without_scene() {
+  const double K = 2;
+  scene_t *scenes[2];
+  for (size_t i = 0; i < 2; i++) {
+    scenes[i] = scene_init();
+    body_t *mass = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(mass, (vector_t){3, 1});
+    scene_add_body(scenes[i], mass);
+    body_t *anchor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+    scene_add_body(scenes[i], anchor);
+    if (i == 0) {
+      create_spring(scenes[i], K, mass, anchor);
+    } else {
+      scene_add_force_creator(scenes[i], (force_creator_t)spring,
+                              aux_init(mass, anchor, K),
+                              (free_func_t)free_aux);
+    }
+  }
+  for (int i = 0; i < 100; i++) {
+    scene_tick(scenes[0], 0.01);
+    scene_tick(scenes[1], 0.01);
+    assert(vec_equal(body_get_centroid(scene_get_body(scenes[0], 0)),
+                     body_get_centroid(scene_get_body(scenes[1], 0))));
+  }
+  scene_free(scenes[0]);
+  scene_free(scenes[1]);
+}
+
+// Adds bodies at random positions to a scene
+void add_random_bodies(scene_t *scene, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = body_init(make_shape(), 1 + rand() % 10,
+                             (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){rand() % 500, rand() % 500});
+    scene_add_body(scene, body);
+  }
+}
+
+// Tests that Barnes-Hut gravity with theta = 0 matches per-pair gravity
+void test_barnes_hut_gravity() {
+  const double G = 100;
+  const size_t NUM_BODIES = 60;
+  scene_t *pairs = scene_init();
+  scene_t *tree = scene_init();
+  srand(8);
+  add_random_bodies(pairs, NUM_BODIES);
+  srand(8);
+  add_random_bodies(tree, NUM_BODIES);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      create_newtonian_gravity(pairs, G, scene_get_body(pairs, i),
+                               scene_get_body(pairs, j));
+    }
+  }
+  create_barnes_hut_gravity(tree, G, 0);
+  // an immovable body is ignored rather than pulling with infinite force
+  body_t *anchor = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+  scene_add_body(tree, anchor);
+  for (int i = 0; i < 50; i++) {
+    scene_tick(pairs, 0.01);
+    scene_tick(tree, 0.01);
+    for (size_t j = 0; j < NUM_BODIES; j++) {
+      assert(vec_isclose(body_get_centroid(scene_get_body(pairs, j)),
+                         body_get_centroid(scene_get_body(tree, j))));
+    }
+  }
+  assert(vec_equal(body_get_centroid(anchor), VEC_ZERO));
+  // removing bodies doesn't remove the force
+  scene_remove_body(tree, 0);
+  scene_tick(tree, 0.01);
+  assert(scene_bodies(tree) == NUM_BODIES);
+  scene_free(pairs);
+  scene_free(tree);
+}
+
+// Tests that all-pairs gravity gives exactly the same result as per-pair
+// gravity, including when other forces act on the same bodies
+void test_all_pairs_gravity() {
+  const double G = 100;
+  const size_t NUM_BODIES = 40;
+  scene_t *pairs = scene_init();
+  scene_t *batched = scene_init();
+  srand(9);
+  add_random_bodies(pairs, NUM_BODIES);
+  srand(9);
+  add_random_bodies(batched, NUM_BODIES);
+  create_drag(pairs, 0.5, scene_get_body(pairs, 3));
+  create_drag(batched, 0.5, scene_get_body(batched, 3));
+  list_t *bodies = list_init(NUM_BODIES, NULL);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      create_newtonian_gravity(pairs, G, scene_get_body(pairs, i),
+                               scene_get_body(pairs, j));
+    }
+    list_add(bodies, scene_get_body(batched, i));
+  }
+  create_all_pairs_gravity(batched, G, bodies);
+  for (int i = 0; i < 100; i++) {
+    scene_tick(pairs, 0.01);
+    scene_tick(batched, 0.01);
+    for (size_t j = 0; j < NUM_BODIES; j++) {
+      assert(vec_equal(body_get_centroid(scene_get_body(pairs, j)),
+                       body_get_centroid(scene_get_body(batched, j))));
+      assert(vec_equal(body_get_velocity(scene_get_body(pairs, j)),
+                       body_get_velocity(scene_get_body(batched, j))));
+    }
+  }
+  scene_free(pairs);
+  scene_free(batched);
+}
+
+// Tests that removing one body from all-pairs gravity leaves the rest
+// attracting each other, as per-pair gravity does
+void test_all_pairs_gravity_removed() {
+  const double G = 100;
+  const size_t NUM_BODIES = 20;
+  scene_t *pairs = scene_init();
+  scene_t *batched = scene_init();
+  srand(10);
+  add_random_bodies(pairs, NUM_BODIES);
+  srand(10);
+  add_random_bodies(batched, NUM_BODIES);
+  list_t *bodies = list_init(NUM_BODIES, NULL);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    for (size_t j = i + 1; j < NUM_BODIES; j++) {
+      create_newtonian_gravity(pairs, G, scene_get_body(pairs, i),
+                               scene_get_body(pairs, j));
+    }
+    list_add(bodies, scene_get_body(batched, i));
+  }
+  create_all_pairs_gravity(batched, G, bodies);
+  for (int i = 0; i < 100; i++) {
+    if (i == 10) {
+      scene_remove_body(pairs, 5);
+      scene_remove_body(batched, 5);
+    }
+    scene_tick(pairs, 0.01);
+    scene_tick(batched, 0.01);
+    assert(scene_bodies(batched) == scene_bodies(pairs));
+    for (size_t j = 0; j < scene_bodies(pairs); j++) {
+      assert(vec_equal(body_get_centroid(scene_get_body(pairs, j)),
+                       body_get_centroid(scene_get_body(batched, j))));
+    }
+  }
+  assert(scene_bodies(batched) == NUM_BODIES - 1);
+  assert(!vec_equal(body_get_velocity(scene_get_body(batched, 0)), VEC_ZERO));
+  scene_free(pairs);
+  scene_free(batched);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -163,6 +346,11 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_energy_conservation)
   DO_TEST(test_collisions)
   DO_TEST(test_forces_removed)
+  DO_TEST(test_body_outside_scene)
+  DO_TEST(test_aux_without_scene)
+  DO_TEST(test_barnes_hut_gravity)
+  DO_TEST(test_all_pairs_gravity)
+  DO_TEST(test_all_pairs_gravity_removed)
 
   puts("forces_test PASS");
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "frame_timer.h"
+#include "test_util.h"
+#include <assert.h>
+#include <time.h>
+
+void test_frame_timer_now() {
+  double start = frame_timer_now();
+  // the clock keeps counting while the program sleeps, unlike clock()
+  struct timespec pause = {.tv_sec = 0, .tv_nsec = 20 * 1000 * 1000};
+  nanosleep(&pause, NULL);
+  double elapsed = frame_timer_now() - start;
+  assert(elapsed >= 0.02);
+  assert(elapsed < 1);
+}
+
+void test_frame_timer_tick() {
+  frame_timer_t *timer = frame_timer_init(10);
+  assert(frame_timer_tick(timer) == 0);
+  assert(frame_timer_stats(timer).count == 0);
+  struct timespec pause = {.tv_sec = 0, .tv_nsec = 10 * 1000 * 1000};
+  nanosleep(&pause, NULL);
+  double dt = frame_timer_tick(timer);
+  assert(dt >= 0.01);
+  frame_stats_t stats = frame_timer_stats(timer);
+  assert(stats.count == 1);
+  assert(stats.min_seconds == dt && stats.max_seconds == dt);
+  // clearing keeps timing from the last tick
+  frame_timer_clear(timer);
+  assert(frame_timer_stats(timer).count == 0);
+  assert(frame_timer_tick(timer) < 1);
+  assert(frame_timer_stats(timer).count == 1);
+  frame_timer_free(timer);
+}
+
+void test_frame_timer_stats() {
+  frame_timer_t *timer = frame_timer_init(200);
+  frame_stats_t stats = frame_timer_stats(timer);
+  assert(stats.count == 0 && stats.max_seconds == 0);
+  // 1 to 200 milliseconds, out of order
+  for (size_t i = 0; i < 200; i++) {
+    frame_timer_record(timer, (i * 37 % 200 + 1) * 1e-3);
+  }
+  stats = frame_timer_stats(timer);
+  assert(stats.count == 200);
+  assert(isclose(stats.min_seconds, 1e-3));
+  assert(isclose(stats.avg_seconds, 100.5e-3));
+  assert(isclose(stats.p99_seconds, 198e-3));
+  assert(isclose(stats.max_seconds, 200e-3));
+  frame_timer_free(timer);
+}
+
+void test_frame_timer_history() {
+  frame_timer_t *timer = frame_timer_init(4);
+  for (size_t i = 1; i <= 10; i++) {
+    frame_timer_record(timer, i);
+  }
+  // only the last 4 times are kept
+  frame_stats_t stats = frame_timer_stats(timer);
+  assert(stats.count == 4);
+  assert(stats.min_seconds == 7);
+  assert(stats.avg_seconds == 8.5);
+  assert(stats.p99_seconds == 10);
+  assert(stats.max_seconds == 10);
+  frame_timer_free(timer);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_frame_timer_now)
+  DO_TEST(test_frame_timer_tick)
+  DO_TEST(test_frame_timer_stats)
+  DO_TEST(test_frame_timer_history)
+
+  puts("frame_timer_test PASS");
+}
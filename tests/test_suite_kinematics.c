@@ -0,0 +1,118 @@
+#include "kinematics.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// fills entry i of a store with values derived from i
+void set_entry(kinematics_t *kinematics, size_t i, double value) {
+  kinematics->mass[i] = 1 + value;
+  kinematics->inverse_mass[i] = 1 / (1 + value);
+  kinematics->x[i] = value;
+  kinematics->y[i] = -value;
+  kinematics->velocity_x[i] = 2 * value;
+  kinematics->velocity_y[i] = 3;
+  kinematics->old_velocity_x[i] = 2 * value;
+  kinematics->old_velocity_y[i] = 3;
+  kinematics->orientation[i] = 0;
+  kinematics->angular_velocity[i] = 0.1;
+  kinematics->force_x[i] = 1 + value;
+  kinematics->force_y[i] = 0;
+}
+
+void test_kinematics_add_remove() {
+  kinematics_t *kinematics = kinematics_init(0);
+  // the bodies are only compared, so any distinct pointers will do
+  body_t **bodies = malloc(sizeof(body_t *) * 100);
+  for (size_t i = 0; i < 100; i++) {
+    bodies[i] = (body_t *)&bodies[i];
+    assert(kinematics_add(kinematics, bodies[i]) == i);
+    set_entry(kinematics, i, i);
+  }
+  assert(kinematics->size == 100);
+  // the values survived growing the arrays
+  for (size_t i = 0; i < 100; i++) {
+    assert(kinematics->x[i] == i && kinematics->bodies[i] == bodies[i]);
+  }
+  // the last entry moves into the gap
+  assert(kinematics_remove(kinematics, 10) == bodies[99]);
+  assert(kinematics->size == 99);
+  assert(kinematics->x[10] == 99 && kinematics->y[10] == -99);
+  assert(kinematics->bodies[10] == bodies[99]);
+  assert(kinematics_remove(kinematics, 98) == NULL);
+  assert(kinematics->size == 98);
+  free(bodies);
+  kinematics_free(kinematics);
+}
+
+void test_kinematics_integrate() {
+  const double DT = 0.5;
+  kinematics_t *kinematics = kinematics_init(4);
+  for (size_t i = 0; i < 4; i++) {
+    kinematics_add(kinematics, NULL);
+    set_entry(kinematics, i, i);
+  }
+  kinematics_integrate(kinematics, DT);
+  for (size_t i = 0; i < 4; i++) {
+    // a = F / m = 1, so v goes from 2i to 2i + DT
+    double velocity = 2.0 * i + DT;
+    assert(isclose(kinematics->velocity_x[i], velocity));
+    assert(kinematics->old_velocity_x[i] == kinematics->velocity_x[i]);
+    assert(isclose(kinematics->x[i], i + DT / 2 * (velocity + 2.0 * i)));
+    assert(isclose(kinematics->y[i], -(double)i + DT * 3));
+    assert(isclose(kinematics->orientation[i], 0.1));
+    assert(kinematics->force_x[i] == 0 && kinematics->force_y[i] == 0);
+  }
+  kinematics_free(kinematics);
+}
+
+void test_kinematics_lanes() {
+  const double DT = 0.01;
+  // not a multiple of any vector width, so some entries are left over
+  const size_t SIZE = 11;
+  kinematics_t *vectorized = kinematics_init(SIZE);
+  kinematics_t *scalar = kinematics_init(SIZE);
+  for (size_t i = 0; i < SIZE; i++) {
+    kinematics_add(vectorized, NULL);
+    kinematics_add(scalar, NULL);
+    // values whose products and quotients need rounding
+    set_entry(vectorized, i, i * 0.37 + 0.1);
+    set_entry(scalar, i, i * 0.37 + 0.1);
+  }
+  for (size_t step = 0; step < 10; step++) {
+    for (size_t i = 0; i < SIZE; i++) {
+      vectorized->force_x[i] = scalar->force_x[i] = 1.0 / (i + step + 3);
+      vectorized->force_y[i] = scalar->force_y[i] = -0.3 * i;
+    }
+    kinematics_integrate(vectorized, DT);
+    kinematics_integrate_scalar(scalar, DT);
+  }
+  assert(kinematics_lanes() >= 1);
+  for (size_t i = 0; i < SIZE; i++) {
+    assert(vectorized->x[i] == scalar->x[i]);
+    assert(vectorized->y[i] == scalar->y[i]);
+    assert(vectorized->velocity_x[i] == scalar->velocity_x[i]);
+    assert(vectorized->velocity_y[i] == scalar->velocity_y[i]);
+    assert(vectorized->old_velocity_x[i] == scalar->old_velocity_x[i]);
+    assert(vectorized->orientation[i] == scalar->orientation[i]);
+    assert(vectorized->force_x[i] == 0 && vectorized->force_y[i] == 0);
+  }
+  kinematics_free(vectorized);
+  kinematics_free(scalar);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_kinematics_add_remove)
+  DO_TEST(test_kinematics_integrate)
+  DO_TEST(test_kinematics_lanes)
+
+  puts("kinematics_test PASS");
+}
@@ -4,6 +4,75 @@
 #include <math.h>
 #include <stdlib.h>
 
+// Makes a list holding the integers 0 to n - 1
+list_t *make_int_list(size_t n) {
+  list_t *list = list_init(0, free);
+  for (size_t i = 0; i < n; i++) {
+    size_t *value = malloc(sizeof(*value));
+    *value = i;
+    list_add(list, value);
+  }
+  return list;
+}
+
+size_t get_int(list_t *list, size_t index) {
+  return *(size_t *)list_get(list, index);
+}
+
+void test_list_growth() {
+  list_t *list = make_int_list(1000);
+  assert(list_size(list) == 1000);
+  for (size_t i = 0; i < 1000; i++) {
+    assert(get_int(list, i) == i);
+  }
+  list_clear(list);
+  assert(list_size(list) == 0);
+  list_reserve(list, 10);
+  size_t *value = malloc(sizeof(*value));
+  *value = 7;
+  list_add(list, value);
+  assert(get_int(list, 0) == 7);
+  list_free(list);
+}
+
+void test_list_remove() {
+  list_t *list = make_int_list(5);
+  // shifting removal keeps the order
+  size_t *removed = list_remove(list, 1);
+  assert(*removed == 1);
+  free(removed);
+  assert(get_int(list, 1) == 2 && get_int(list, 3) == 4);
+  // swap removal moves the last element into the gap
+  removed = list_swap_remove(list, 0);
+  assert(*removed == 0);
+  free(removed);
+  assert(list_size(list) == 3);
+  assert(get_int(list, 0) == 4 && get_int(list, 1) == 2 &&
+         get_int(list, 2) == 3);
+  removed = list_swap_remove(list, 2);
+  free(removed);
+  assert(list_size(list) == 2 && get_int(list, 1) == 2);
+  list_free(list);
+}
+
+bool is_multiple(void *element, void *aux) {
+  return *(size_t *)element % *(size_t *)aux == 0;
+}
+
+void test_list_remove_if() {
+  list_t *list = make_int_list(100);
+  size_t divisor = 3;
+  assert(list_remove_if(list, is_multiple, &divisor, true) == 34);
+  assert(list_size(list) == 66);
+  for (size_t i = 0; i < list_size(list); i++) {
+    assert(get_int(list, i) == i / 2 * 3 + 1 + i % 2);
+  }
+  divisor = 1;
+  assert(list_remove_if(list, is_multiple, &divisor, true) == 66);
+  assert(list_size(list) == 0);
+  list_free(list);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -13,5 +82,9 @@ int main(int argc, char *argv[]) {
     read_testname(argv[1], testname, sizeof(testname));
   }
 
+  DO_TEST(test_list_growth)
+  DO_TEST(test_list_remove)
+  DO_TEST(test_list_remove_if)
+
   puts("list_test PASS");
 }
\ No newline at end of file
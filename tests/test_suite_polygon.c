@@ -219,6 +219,74 @@ void test_weird_rotate() {
   list_free(w);
 }
 
+// polygon_t versions of the tests above must agree with the list versions
+void test_polygon_conversion() {
+  list_t *w = make_weird();
+  polygon_t *polygon = polygon_from_list(w);
+  assert(polygon->size == list_size(w));
+  list_t *back = polygon_to_list(polygon);
+  polygon_t *copy = polygon_copy(polygon);
+  assert(list_size(back) == list_size(w));
+  for (size_t i = 0; i < list_size(w); i++) {
+    vector_t vertex = *(vector_t *)list_get(w, i);
+    assert(vec_equal(polygon_get_vertex(polygon, i), vertex));
+    assert(vec_equal(polygon_get_vertex(copy, i), vertex));
+    assert(vec_equal(*(vector_t *)list_get(back, i), vertex));
+  }
+  polygon_free(copy);
+  polygon_free(polygon);
+  list_free(back);
+  list_free(w);
+}
+
+void test_polygon_area_centroid() {
+  list_t *w = make_weird();
+  polygon_t *polygon = polygon_from_list(w);
+  assert(isclose(polygon_compute_area(polygon), 23));
+  assert(vec_isclose(polygon_compute_centroid(polygon),
+                     (vector_t){-223.0 / 138.0, -51.0 / 46.0}));
+  bounding_box_t box = polygon_compute_bounding_box(polygon);
+  bounding_box_t expected = polygon_bounding_box(w);
+  assert(vec_equal(box.min, expected.min));
+  assert(vec_equal(box.max, expected.max));
+  polygon_free(polygon);
+  list_free(w);
+}
+
+void test_polygon_transform() {
+  list_t *w = make_weird();
+  polygon_t *polygon = polygon_from_list(w);
+  polygon_apply_translation(polygon, (vector_t){-10, -20});
+  polygon_translate(w, (vector_t){-10, -20});
+  // Rotate 90 degrees around (0, 2)
+  polygon_apply_rotation(polygon, M_PI / 2, (vector_t){0, 2});
+  polygon_rotate(w, M_PI / 2, (vector_t){0, 2});
+  for (size_t i = 0; i < list_size(w); i++) {
+    assert(vec_isclose(polygon_get_vertex(polygon, i),
+                       *(vector_t *)list_get(w, i)));
+  }
+  assert(isclose(polygon_compute_area(polygon), 23));
+  assert(vec_isclose(polygon_compute_centroid(polygon), polygon_centroid(w)));
+  // a precomputed rotation moves the vertices to exactly the same places
+  rotation_t rotation = rotation_from_angle(0.3);
+  polygon_t *out = polygon_init(polygon->size);
+  polygon_t *expected = polygon_init(polygon->size);
+  polygon_transform_by(polygon, rotation, (vector_t){1, 2}, out);
+  polygon_transform_into(polygon, 0.3, (vector_t){1, 2}, expected);
+  polygon_apply_rotation_by(polygon, rotation, (vector_t){0, 2});
+  polygon_rotate_by(w, rotation, (vector_t){0, 2});
+  for (size_t i = 0; i < list_size(w); i++) {
+    assert(vec_equal(polygon_get_vertex(out, i),
+                     polygon_get_vertex(expected, i)));
+    assert(vec_isclose(polygon_get_vertex(polygon, i),
+                       *(vector_t *)list_get(w, i)));
+  }
+  polygon_free(expected);
+  polygon_free(out);
+  polygon_free(polygon);
+  list_free(w);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests? True if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -240,6 +308,9 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_weird_area_centroid);
   DO_TEST(test_weird_translate);
   DO_TEST(test_weird_rotate);
+  DO_TEST(test_polygon_conversion);
+  DO_TEST(test_polygon_area_centroid);
+  DO_TEST(test_polygon_transform);
 
   puts("polygon_test PASS");
 }
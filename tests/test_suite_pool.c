@@ -0,0 +1,81 @@
+#include "pool.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct {
+  double value;
+  size_t id;
+} record_t;
+
+void test_pool_alloc_release() {
+  pool_t *pool = pool_init(sizeof(record_t));
+  assert(pool_object_size(pool) == sizeof(record_t));
+  assert(pool_live(pool) == 0);
+
+  // enough objects to need several slabs
+  const size_t N = 1000;
+  record_t **records = malloc(sizeof(record_t *) * N);
+  for (size_t i = 0; i < N; i++) {
+    records[i] = pool_alloc(pool);
+    assert((uintptr_t)records[i] % alignof(max_align_t) == 0);
+    records[i]->value = i * 0.5;
+    records[i]->id = i;
+  }
+  assert(pool_live(pool) == N);
+  // no two live objects overlap
+  for (size_t i = 0; i < N; i++) {
+    assert(records[i]->id == i);
+    assert(records[i]->value == i * 0.5);
+  }
+
+  // release every other object, then take them back
+  for (size_t i = 0; i < N; i += 2) {
+    pool_release(pool, records[i]);
+  }
+  assert(pool_live(pool) == N / 2);
+  for (size_t i = 0; i < N; i += 2) {
+    records[i] = pool_alloc(pool);
+    records[i]->id = i;
+  }
+  assert(pool_live(pool) == N);
+  for (size_t i = 0; i < N; i++) {
+    assert(records[i]->id == i);
+    pool_release(pool, records[i]);
+  }
+  assert(pool_live(pool) == 0);
+  free(records);
+  pool_free(pool);
+}
+
+void test_pool_tiny_objects() {
+  // objects smaller than a pointer still get room for the free list
+  pool_t *pool = pool_init(1);
+  char *a = pool_alloc(pool);
+  char *b = pool_alloc(pool);
+  assert(a != b);
+  *a = 'a';
+  *b = 'b';
+  assert(*a == 'a');
+  pool_release(pool, a);
+  pool_release(pool, b);
+  pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_pool_alloc_release)
+  DO_TEST(test_pool_tiny_objects)
+
+  puts("pool_test PASS");
+}
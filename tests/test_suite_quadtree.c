@@ -0,0 +1,130 @@
+#include "quadtree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double MIN_PULL_DISTANCE = 0.5;
+
+// Computes quadtree_field() the slow way
+vector_t brute_force_field(vector_t *positions, double *masses, size_t count,
+                           vector_t point) {
+  vector_t field = VEC_ZERO;
+  for (size_t i = 0; i < count; i++) {
+    vector_t direction = vec_subtract(positions[i], point);
+    double distance = sqrt(vec_dot(direction, direction));
+    if (distance == 0 || distance < MIN_PULL_DISTANCE) {
+      continue;
+    }
+    field = vec_add(field, vec_multiply(masses[i] / pow(distance, 3),
+                                        direction));
+  }
+  return field;
+}
+
+double norm(vector_t v) { return sqrt(vec_dot(v, v)); }
+
+// Builds a tree of random points and returns the total error of the
+// approximate field at every point, relative to the total exact field
+double relative_error(size_t count, double theta) {
+  vector_t *positions = malloc(sizeof(vector_t) * count);
+  double *masses = malloc(sizeof(double) * count);
+  quadtree_t *tree = quadtree_init();
+  for (size_t i = 0; i < count; i++) {
+    // clump half of the points together to get an uneven tree
+    double spread = i % 2 == 0 ? 1000 : 50;
+    positions[i] = (vector_t){(double)rand() / RAND_MAX * spread,
+                              (double)rand() / RAND_MAX * spread};
+    masses[i] = 1 + rand() % 100;
+    quadtree_add_point(tree, positions[i], masses[i]);
+  }
+  assert(quadtree_size(tree) == count);
+  quadtree_build(tree);
+  double total_error = 0;
+  double total_field = 0;
+  for (size_t i = 0; i < count; i++) {
+    vector_t exact = brute_force_field(positions, masses, count, positions[i]);
+    vector_t approximate =
+        quadtree_field(tree, positions[i], theta, MIN_PULL_DISTANCE);
+    total_error += norm(vec_subtract(exact, approximate));
+    total_field += norm(exact);
+  }
+  quadtree_free(tree);
+  free(positions);
+  free(masses);
+  return total_error / total_field;
+}
+
+void test_empty_tree() {
+  quadtree_t *tree = quadtree_init();
+  quadtree_build(tree);
+  assert(quadtree_size(tree) == 0);
+  assert(vec_equal(quadtree_field(tree, (vector_t){1, 2}, 0.5, 0), VEC_ZERO));
+  quadtree_free(tree);
+}
+
+void test_two_points() {
+  quadtree_t *tree = quadtree_init();
+  quadtree_add_point(tree, (vector_t){0, 0}, 2);
+  quadtree_add_point(tree, (vector_t){3, 4}, 5);
+  quadtree_build(tree);
+  // a point doesn't pull on itself
+  assert(vec_isclose(quadtree_field(tree, (vector_t){0, 0}, 0.5, 0),
+                     vec_multiply(5.0 / 125, (vector_t){3, 4})));
+  assert(vec_isclose(quadtree_field(tree, (vector_t){3, 4}, 0.5, 0),
+                     vec_multiply(2.0 / 125, (vector_t){-3, -4})));
+  // nor do points that are too close
+  assert(vec_equal(quadtree_field(tree, (vector_t){0, 0}, 0.5, 6), VEC_ZERO));
+  // reusing the tree forgets the old points
+  quadtree_clear(tree);
+  quadtree_add_point(tree, (vector_t){1, 0}, 1);
+  quadtree_build(tree);
+  assert(vec_isclose(quadtree_field(tree, (vector_t){0, 0}, 0.5, 0),
+                     (vector_t){1, 0}));
+  quadtree_free(tree);
+}
+
+void test_exact_field() {
+  srand(5);
+  assert(relative_error(2000, 0) < 1e-9);
+}
+
+void test_approximate_field() {
+  srand(6);
+  assert(relative_error(5000, 0.5) < 0.02);
+  // coarser approximations are less accurate
+  assert(relative_error(5000, 1) < 0.1);
+}
+
+// Many points at one position can't be split, which must not recurse forever
+void test_coincident_points() {
+  quadtree_t *tree = quadtree_init();
+  for (size_t i = 0; i < 100; i++) {
+    quadtree_add_point(tree, (vector_t){7, 7}, 1);
+  }
+  quadtree_add_point(tree, (vector_t){17, 7}, 1);
+  quadtree_build(tree);
+  assert(vec_isclose(quadtree_field(tree, (vector_t){17, 7}, 0.5, 0),
+                     (vector_t){-1, 0}));
+  assert(vec_isclose(quadtree_field(tree, (vector_t){7, 7}, 0.5, 0),
+                     (vector_t){0.01, 0}));
+  quadtree_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_tree)
+  DO_TEST(test_two_points)
+  DO_TEST(test_exact_field)
+  DO_TEST(test_approximate_field)
+  DO_TEST(test_coincident_points)
+
+  puts("quadtree_test PASS");
+}
@@ -227,6 +227,543 @@ void test_reaping() {
   scene_free(scene);
 }
 
+// Counts calls into an int
+void count_ticks(void *aux) { (*(int *)aux)++; }
+
+void test_mass_removal() {
+  const size_t N = 100;
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < N; i++) {
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){i, 0});
+    scene_add_body(scene, body);
+  }
+  // a force on each pair of neighbours
+  int *pair_calls = malloc(sizeof(*pair_calls));
+  *pair_calls = 0;
+  for (size_t i = 0; i + 1 < N; i++) {
+    list_t *bodies = list_init(2, NULL);
+    list_add(bodies, scene_get_body(scene, i));
+    list_add(bodies, scene_get_body(scene, i + 1));
+    scene_add_bodies_force_creator(scene, count_ticks, pair_calls, bodies,
+                                   i == 1 ? free : NULL);
+  }
+  // a force that isn't tied to any bodies
+  int *global_calls = malloc(sizeof(*global_calls));
+  *global_calls = 0;
+  scene_add_force_creator(scene, count_ticks, global_calls, free);
+
+  // remove every body whose index is a multiple of 3
+  for (size_t i = 0; i < N; i += 3) {
+    body_remove(scene_get_body(scene, i));
+  }
+  scene_tick(scene, 1);
+  assert(scene_bodies(scene) == N - (N + 2) / 3);
+  // the remaining bodies keep their order
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    size_t original = i / 2 * 3 + 1 + i % 2;
+    assert(body_get_centroid(scene_get_body(scene, i)).x == original);
+  }
+
+  // only the pairs (3k + 1, 3k + 2) survived, along with the global force
+  *pair_calls = 0;
+  scene_tick(scene, 1);
+  assert(*pair_calls == (int)(N / 3));
+  assert(*global_calls == 2);
+  scene_free(scene);
+}
+
+void test_pooled_bodies() {
+  scene_t *scene = scene_init();
+  body_t *anchor = scene_body_init(scene, make_shape(), INFINITY,
+                                   (rgb_color_t){0, 0, 0}, NULL, NULL);
+  assert(scene_bodies(scene) == 1 && scene_get_body(scene, 0) == anchor);
+  // create and destroy bodies, forces and their aux records many times
+  for (size_t round = 0; round < 50; round++) {
+    for (size_t i = 0; i < 20; i++) {
+      size_t *info = malloc(sizeof(*info));
+      *info = i;
+      body_t *body = scene_body_init(scene, make_shape(), 1,
+                                     (rgb_color_t){0, 0, 0}, info, free);
+      body_set_centroid(body, (vector_t){10 * i + 10, 0});
+      create_spring(scene, 1, anchor, body);
+      create_drag(scene, 1, body);
+    }
+    assert(scene_bodies(scene) == 21);
+    assert(scene_forces(scene) == 40);
+    scene_tick(scene, 0.01);
+    for (size_t i = 1; i < scene_bodies(scene); i++) {
+      assert(*(size_t *)body_get_info(scene_get_body(scene, i)) == i - 1);
+      body_remove(scene_get_body(scene, i));
+    }
+    scene_tick(scene, 0.01);
+    assert(scene_bodies(scene) == 1 && scene_forces(scene) == 0);
+  }
+  scene_free(scene);
+}
+
+void test_frame_arena() {
+  scene_t *scene = scene_init();
+  body_t *body = scene_body_init(scene, make_shape(), 1,
+                                 (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_set_centroid(body, (vector_t){5, 5});
+  arena_t *arena = scene_frame_arena(scene);
+  polygon_t *shape = body_get_shape_in_arena(body, arena);
+  assert(shape->size == 4);
+  assert(shape->x[0] == 4 && shape->y[0] == 4);
+  assert(shape->x[2] == 6 && shape->y[2] == 6);
+  // the copy doesn't follow the body
+  body_set_centroid(body, VEC_ZERO);
+  assert(shape->x[0] == 4);
+  assert(arena_used(arena) > 0);
+  // ticking releases the frame's memory
+  scene_tick(scene, 0);
+  assert(arena_used(arena) == 0);
+  body_get_shape_in_arena(body, arena);
+  scene_frame_begin(scene);
+  assert(arena_used(arena) == 0);
+  scene_free(scene);
+}
+
+void test_body_handles() {
+  scene_t *scene = scene_init();
+  body_t *bodies[3];
+  body_handle_t handles[3];
+  for (size_t i = 0; i < 3; i++) {
+    bodies[i] = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    scene_add_body(scene, bodies[i]);
+    handles[i] = scene_get_handle(scene, bodies[i]);
+  }
+  for (size_t i = 0; i < 3; i++) {
+    assert(scene_resolve(scene, handles[i]) == bodies[i]);
+  }
+  // a spring to the removed body must stop without touching it
+  create_spring(scene, 1, bodies[0], bodies[1]);
+  body_remove(bodies[1]);
+  // still valid until the end of the tick
+  assert(scene_resolve(scene, handles[1]) == bodies[1]);
+  scene_tick(scene, 1);
+  assert(scene_resolve(scene, handles[1]) == NULL);
+  assert(scene_resolve(scene, handles[0]) == bodies[0]);
+  assert(scene_resolve(scene, handles[2]) == bodies[2]);
+
+  // the slot is reused, but the old handle stays dead
+  body_t *body = scene_body_init(scene, make_shape(), 1,
+                                 (rgb_color_t){0, 0, 0}, NULL, NULL);
+  body_handle_t handle = scene_get_handle(scene, body);
+  assert(handle.index == handles[1].index);
+  assert(scene_resolve(scene, handle) == body);
+  assert(scene_resolve(scene, handles[1]) == NULL);
+  scene_free(scene);
+}
+
+// Builds a scene with a chain of bodies joined by springs, with gravity and
+// drag, where the bodies also spin
+scene_t *make_spring_chain(size_t count) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = body_init(make_shape(), 1 + i % 3, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){3 * i, i % 2});
+    body_set_velocity(body, (vector_t){0, (double)i - 5});
+    body_set_rotational_velocity(body, 0.01 * i);
+    scene_add_body(scene, body);
+    if (i > 0) {
+      create_spring(scene, 2, scene_get_body(scene, i - 1), body);
+      create_newtonian_gravity(scene, 50, scene_get_body(scene, i - 1), body);
+    }
+    create_drag(scene, 0.1, body);
+  }
+  return scene;
+}
+
+void test_dense_storage() {
+  const size_t COUNT = 20;
+  scene_t *sparse = make_spring_chain(COUNT);
+  scene_t *dense = make_spring_chain(COUNT);
+  scene_set_dense_storage(dense);
+  for (int step = 0; step < 200; step++) {
+    if (step == 50) {
+      // removing bodies moves others within the dense arrays
+      body_remove(scene_get_body(sparse, 3));
+      body_remove(scene_get_body(dense, 3));
+      body_remove(scene_get_body(sparse, COUNT - 1));
+      body_remove(scene_get_body(dense, COUNT - 1));
+    }
+    if (step == 100) {
+      // bodies added later are stored densely too
+      body_t *body = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+      body_add_impulse(body, (vector_t){4, 0});
+      scene_add_body(sparse, body);
+      body = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+      body_add_impulse(body, (vector_t){4, 0});
+      scene_add_body(dense, body);
+    }
+    scene_tick(sparse, 0.01);
+    scene_tick(dense, 0.01);
+    // the same arithmetic runs either way
+    assert(scene_bodies(sparse) == scene_bodies(dense));
+    for (size_t i = 0; i < scene_bodies(sparse); i++) {
+      body_t *expected = scene_get_body(sparse, i);
+      body_t *actual = scene_get_body(dense, i);
+      assert(vec_equal(body_get_centroid(expected), body_get_centroid(actual)));
+      assert(vec_equal(body_get_velocity(expected), body_get_velocity(actual)));
+      bounding_box_t expected_box = body_get_bounding_box(expected);
+      bounding_box_t actual_box = body_get_bounding_box(actual);
+      assert(vec_isclose(expected_box.min, actual_box.min));
+      assert(vec_isclose(expected_box.max, actual_box.max));
+    }
+  }
+  scene_free(sparse);
+  scene_free(dense);
+}
+
+// a force creator without a list of bodies, which pulls every body left
+void push_all_left(void *scene) {
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_add_force(scene_get_body(scene, i), (vector_t){-1, 0});
+  }
+}
+
+void test_threaded_tick() {
+  const size_t COUNT = 40;
+  size_t thread_counts[] = {2, 3, 8};
+  for (size_t t = 0; t < sizeof(thread_counts) / sizeof(*thread_counts);
+       t++) {
+    for (int dense = 0; dense < 2; dense++) {
+      scene_t *serial = make_spring_chain(COUNT);
+      scene_t *threaded = make_spring_chain(COUNT);
+      scene_add_force_creator(serial, push_all_left, serial, NULL);
+      scene_add_force_creator(threaded, push_all_left, threaded, NULL);
+      // forces added after an undeclared one can't run before it
+      create_drag(serial, 0.2, scene_get_body(serial, 0));
+      create_drag(threaded, 0.2, scene_get_body(threaded, 0));
+      if (dense) {
+        scene_set_dense_storage(serial);
+        scene_set_dense_storage(threaded);
+      }
+      scene_set_threads(threaded, thread_counts[t]);
+      for (int step = 0; step < 100; step++) {
+        if (step == 50) {
+          // the colors are rebuilt without the removed forces
+          body_remove(scene_get_body(serial, 5));
+          body_remove(scene_get_body(threaded, 5));
+        }
+        scene_tick(serial, 0.01);
+        scene_tick(threaded, 0.01);
+        assert(scene_bodies(serial) == scene_bodies(threaded));
+        assert(scene_forces(serial) == scene_forces(threaded));
+        for (size_t i = 0; i < scene_bodies(serial); i++) {
+          body_t *expected = scene_get_body(serial, i);
+          body_t *actual = scene_get_body(threaded, i);
+          assert(vec_equal(body_get_centroid(expected),
+                           body_get_centroid(actual)));
+          assert(vec_equal(body_get_velocity(expected),
+                           body_get_velocity(actual)));
+        }
+      }
+      scene_free(serial);
+      scene_free(threaded);
+    }
+  }
+}
+
+// Adds forces of every kind on top of a spring chain: additive creators that
+// share a body, one without declared bodies that reads and sets its bodies'
+// forces, and a hub body with enough springs that its forces are logged past
+// the insertion sort
+void add_mixed_forces(scene_t *scene, size_t count) {
+  list_t *group = list_init(4, NULL);
+  for (size_t i = 10; i < 14; i++) {
+    list_add(group, scene_get_body(scene, i));
+  }
+  create_all_pairs_gravity(scene, 30, group);
+  create_spring(scene, 1, scene_get_body(scene, 11), scene_get_body(scene, 12));
+  body_t *hub = body_init(make_shape(), 10, (rgb_color_t){0, 0, 0});
+  body_set_centroid(hub, (vector_t){0, 20});
+  scene_add_body(scene, hub);
+  for (size_t i = 0; i < count; i++) {
+    create_spring(scene, 0.5, hub, scene_get_body(scene, i));
+  }
+}
+
+void test_force_coloring() {
+  const size_t COUNT = 40;
+  // each body in the chain has 2 springs, 2 gravities and a drag,
+  // so the chain's creators need only 5 colors, however long it is
+  scene_t *chain = make_spring_chain(COUNT);
+  scene_set_threads(chain, 2);
+  assert(scene_force_colors(chain) == 5);
+  scene_free(chain);
+
+  size_t thread_counts[] = {2, 3, 4, 8};
+  for (size_t t = 0; t < sizeof(thread_counts) / sizeof(*thread_counts);
+       t++) {
+    scene_t *serial = make_spring_chain(COUNT);
+    scene_t *threaded = make_spring_chain(COUNT);
+    add_mixed_forces(serial, COUNT);
+    add_mixed_forces(threaded, COUNT);
+    scene_set_threads(threaded, thread_counts[t]);
+    for (int step = 0; step < 100; step++) {
+      scene_tick(serial, 0.01);
+      scene_tick(threaded, 0.01);
+      for (size_t i = 0; i < scene_bodies(serial); i++) {
+        body_t *expected = scene_get_body(serial, i);
+        body_t *actual = scene_get_body(threaded, i);
+        assert(vec_equal(body_get_centroid(expected),
+                         body_get_centroid(actual)));
+        assert(vec_equal(body_get_velocity(expected),
+                         body_get_velocity(actual)));
+      }
+    }
+    // the hub's springs all share it, so each needs a color of its own,
+    // but the chain's creators fit alongside them
+    assert(scene_force_colors(threaded) >= COUNT);
+    assert(scene_force_colors(threaded) < COUNT + 10);
+    scene_free(serial);
+    scene_free(threaded);
+  }
+}
+
+void test_scene_advance() {
+  scene_t *scene = scene_init();
+  assert(scene_interpolation_alpha(scene) == 1);
+  // steps and frames that are exact in binary, so the sums are too
+  const double STEP = 0.125;
+  scene_set_fixed_step(scene, STEP, 3);
+  body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(body, (vector_t){1, 0});
+  scene_add_body(scene, body);
+  // the same body, ticked by hand
+  body_t *expected = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+  body_set_velocity(expected, (vector_t){1, 0});
+
+  assert(scene_advance(scene, 2.5 * STEP) == 2);
+  body_tick(expected, STEP);
+  vector_t previous = body_get_centroid(expected);
+  body_tick(expected, STEP);
+  assert(vec_equal(body_get_centroid(body), body_get_centroid(expected)));
+  assert(vec_equal(body_get_previous_centroid(body), previous));
+  assert(scene_interpolation_alpha(scene) == 0.5);
+  // not enough time for another step, so only alpha moves
+  assert(scene_advance(scene, 0.25 * STEP) == 0);
+  assert(vec_equal(body_get_centroid(body), body_get_centroid(expected)));
+  assert(scene_interpolation_alpha(scene) == 0.75);
+  assert(scene_advance(scene, 0.25 * STEP) == 1);
+  body_tick(expected, STEP);
+  assert(vec_equal(body_get_centroid(body), body_get_centroid(expected)));
+  assert(scene_interpolation_alpha(scene) == 0);
+  // a long frame runs at most 3 steps, and the rest of it is dropped
+  assert(scene_advance(scene, 10) == 3);
+  assert(scene_interpolation_alpha(scene) >= 0);
+  assert(scene_interpolation_alpha(scene) < 1);
+  assert(scene_advance(scene, 0) == 0);
+  // a plain tick draws bodies where it leaves them
+  scene_tick(scene, STEP);
+  assert(scene_interpolation_alpha(scene) == 1);
+  body_free(expected);
+  scene_free(scene);
+}
+
+// Adds a body with a drag force and a spring to the first body, and removes
+// the oldest such body, so the forces are recolored every tick
+void churn_scene(scene_t *scene, size_t step) {
+  body_t *body = body_init(make_shape(), 2, (rgb_color_t){0, 0, 0});
+  body_set_centroid(body, (vector_t){step % 7, 10});
+  scene_add_body(scene, body);
+  create_drag(scene, 0.2, body);
+  create_spring(scene, 1, scene_get_body(scene, 0), body);
+  if (step >= 5) {
+    body_remove(scene_get_body(scene, scene_bodies(scene) - 6));
+  }
+}
+
+// Tests that a threaded scene whose bodies and forces change every tick,
+// reusing the space its colors were built in, still matches a serial one
+void test_force_coloring_churn() {
+  const size_t COUNT = 30;
+  scene_t *serial = make_spring_chain(COUNT);
+  scene_t *threaded = make_spring_chain(COUNT);
+  scene_set_threads(threaded, 3);
+  for (size_t step = 0; step < 100; step++) {
+    churn_scene(serial, step);
+    churn_scene(threaded, step);
+    scene_tick(serial, 0.01);
+    scene_tick(threaded, 0.01);
+    assert(scene_bodies(serial) == scene_bodies(threaded));
+    for (size_t i = 0; i < scene_bodies(serial); i++) {
+      assert(vec_equal(body_get_centroid(scene_get_body(serial, i)),
+                       body_get_centroid(scene_get_body(threaded, i))));
+    }
+  }
+  scene_free(serial);
+  scene_free(threaded);
+}
+
+void test_tick_totals() {
+  scene_t *scene1 = make_spring_chain(5);
+  scene_t *scene2 = make_spring_chain(3);
+  for (size_t i = 0; i < 4; i++) {
+    scene_tick(scene1, 0.01);
+  }
+  scene_tick(scene2, 0.01);
+  // each scene counts only its own ticks
+  scene_tick_totals_t totals1 = scene_get_tick_totals(scene1);
+  scene_tick_totals_t totals2 = scene_get_tick_totals(scene2);
+  assert(totals1.ticks == 4 && totals1.body_updates == 4 * 5);
+  assert(totals2.ticks == 1 && totals2.body_updates == 3);
+  scene_free(scene1);
+  scene_free(scene2);
+}
+
+// records what the hooks were called on
+scene_t *hooked_init = NULL;
+size_t hooked_free_ticks = 0;
+
+void record_init(scene_t *scene) { hooked_init = scene; }
+
+// the scene can still be read while it is being freed
+void record_free(scene_t *scene) {
+  hooked_free_ticks = scene_get_tick_totals(scene).ticks;
+}
+
+void test_scene_hooks() {
+  scene_set_hooks(record_init, record_free);
+  scene_t *scene = scene_init();
+  assert(hooked_init == scene);
+  scene_tick(scene, 0.01);
+  scene_tick(scene, 0.01);
+  scene_free(scene);
+  assert(hooked_free_ticks == 2);
+  scene_set_hooks(NULL, NULL);
+  hooked_init = NULL;
+  scene = scene_init();
+  scene_free(scene);
+  assert(hooked_init == NULL);
+}
+
+// A collision handler that destroys both bodies
+void destroy_both(body_t *body1, body_t *body2, void *aux) {
+  size_t *count = aux;
+  (*count)++;
+  body_remove(body1);
+  body_remove(body2);
+}
+
+// Builds a row of squares where squares 2k and 2k + 1 overlap
+scene_t *make_overlapping_scene(size_t pairs) {
+  scene_t *scene = scene_init();
+  for (size_t i = 0; i < pairs; i++) {
+    body_t *body1 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body1, (vector_t){10 * i, 0});
+    scene_add_body(scene, body1);
+    body_t *body2 = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body2, (vector_t){10 * i + 1, 1});
+    scene_add_body(scene, body2);
+  }
+  return scene;
+}
+
+void test_collision_handler() {
+  const size_t PAIRS = 20;
+  // try every pair, a spatial hash, and an AABB tree,
+  // each with and without threads
+  for (int broad_phase = 0; broad_phase < 6; broad_phase++) {
+    scene_t *scene = make_overlapping_scene(PAIRS);
+    if (broad_phase % 3 == 1) {
+      scene_set_spatial_hash(scene, 3);
+    } else if (broad_phase % 3 == 2) {
+      scene_set_aabb_tree(scene, 0.5);
+    }
+    if (broad_phase >= 3) {
+      scene_set_threads(scene, 3);
+      assert(thread_pool_threads(scene_get_threads(scene)) == 3);
+    } else {
+      assert(scene_get_threads(scene) == NULL);
+    }
+    size_t *count = malloc(sizeof(*count));
+    *count = 0;
+    scene_set_collision_handler(scene, destroy_both, count, free);
+    scene_tick(scene, 1);
+    assert(*count == PAIRS);
+    assert(scene_bodies(scene) == 0);
+    scene_free(scene);
+  }
+}
+
+void count_body(body_t *body, void *aux) { (*(size_t *)aux)++; }
+
+void test_scene_queries() {
+  const size_t PAIRS = 10;
+  for (int use_tree = 0; use_tree < 2; use_tree++) {
+    scene_t *scene = make_overlapping_scene(PAIRS);
+    if (use_tree) {
+      scene_set_aabb_tree(scene, 0.5);
+    }
+    scene_tick(scene, 0);
+    // the box around the first two pairs
+    size_t count = 0;
+    scene_query_box(scene, (bounding_box_t){{-1, -1}, {12, 2}}, count_body,
+                    &count);
+    assert(count == 4);
+    // a horizontal ray through every body
+    count = 0;
+    scene_query_ray(scene, (vector_t){-5, 0.5}, (vector_t){1000, 0.5},
+                    count_body, &count);
+    assert(count == 2 * PAIRS);
+    // a vertical ray through only the first pair
+    count = 0;
+    scene_query_ray(scene, (vector_t){0.5, -5}, (vector_t){0.5, 5},
+                    count_body, &count);
+    assert(count == 2);
+    scene_free(scene);
+  }
+}
+
+typedef struct {
+  scene_t *scene;
+  size_t calls;
+  size_t found;
+} nested_query_t;
+
+// a collision handler that looks around the first body, as gameplay code
+// might to find what else an explosion hits
+void query_from_handler(body_t *body1, body_t *body2, void *aux) {
+  nested_query_t *query = aux;
+  query->calls++;
+  scene_query_box(query->scene, body_get_bounding_box(body1), count_body,
+                  &query->found);
+}
+
+void test_query_from_handler() {
+  const size_t COUNT = 300;
+  size_t calls[2];
+  for (int use_tree = 0; use_tree < 2; use_tree++) {
+    scene_t *scene = scene_init();
+    // the same random squares for both scenes
+    srand(300);
+    for (size_t i = 0; i < COUNT; i++) {
+      body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+      body_set_centroid(body, (vector_t){rand() % 1000 / 10.0,
+                                         rand() % 1000 / 10.0});
+      scene_add_body(scene, body);
+    }
+    if (use_tree) {
+      scene_set_aabb_tree(scene, 0.5);
+    }
+    nested_query_t *query = malloc(sizeof(nested_query_t));
+    *query = (nested_query_t){.scene = scene, .calls = 0, .found = 0};
+    scene_set_collision_handler(scene, query_from_handler, query, free);
+    scene_tick(scene, 0);
+    // the nested queries don't disturb the search for colliding pairs
+    calls[use_tree] = query->calls;
+    // each query finds at least the body it was made around
+    assert(query->found >= query->calls);
+    scene_free(scene);
+  }
+  assert(calls[0] > 0);
+  assert(calls[1] == calls[0]);
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -241,6 +778,20 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_force_creator)
   DO_TEST(test_force_creator_aux)
   DO_TEST(test_reaping)
+  DO_TEST(test_mass_removal)
+  DO_TEST(test_pooled_bodies)
+  DO_TEST(test_frame_arena)
+  DO_TEST(test_body_handles)
+  DO_TEST(test_dense_storage)
+  DO_TEST(test_threaded_tick)
+  DO_TEST(test_force_coloring)
+  DO_TEST(test_force_coloring_churn)
+  DO_TEST(test_scene_advance)
+  DO_TEST(test_tick_totals)
+  DO_TEST(test_scene_hooks)
+  DO_TEST(test_collision_handler)
+  DO_TEST(test_scene_queries)
+  DO_TEST(test_query_from_handler)
 
   puts("scene_test PASS");
 }
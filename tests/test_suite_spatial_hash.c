@@ -0,0 +1,149 @@
+#include "spatial_hash.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Makes a body that is a w x h rectangle centered at the given point
+body_t *make_rectangle(vector_t center, double w, double h) {
+  list_t *shape = list_init(4, free);
+  vector_t *v = malloc(sizeof(*v));
+  *v = (vector_t){center.x - w / 2, center.y - h / 2};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){center.x + w / 2, center.y - h / 2};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){center.x + w / 2, center.y + h / 2};
+  list_add(shape, v);
+  v = malloc(sizeof(*v));
+  *v = (vector_t){center.x - w / 2, center.y + h / 2};
+  list_add(shape, v);
+  return body_init(shape, 1, (rgb_color_t){0, 0, 0});
+}
+
+typedef struct {
+  list_t *bodies;
+  // counts[i * n + j] is how many times the pair (i, j) was reported
+  size_t *counts;
+} pair_counts_t;
+
+size_t index_of(list_t *bodies, body_t *body) {
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    if (list_get(bodies, i) == body) {
+      return i;
+    }
+  }
+  assert(false);
+  return 0;
+}
+
+void count_pair(body_t *body1, body_t *body2, void *aux) {
+  pair_counts_t *counts = aux;
+  size_t i = index_of(counts->bodies, body1);
+  size_t j = index_of(counts->bodies, body2);
+  // body1 must come first in the list
+  assert(i < j);
+  counts->counts[i * list_size(counts->bodies) + j]++;
+}
+
+// Checks that the hash reports exactly the overlapping pairs, each once
+void check_pairs(list_t *bodies, double cell_size) {
+  size_t n = list_size(bodies);
+  pair_counts_t counts = {.bodies = bodies,
+                          .counts = calloc(n * n, sizeof(size_t))};
+  spatial_hash_t *hash = spatial_hash_init(cell_size);
+  assert(spatial_hash_cell_size(hash) == cell_size);
+  // rebuilding twice should not report anything twice
+  spatial_hash_rebuild(hash, bodies);
+  spatial_hash_rebuild(hash, bodies);
+  spatial_hash_query_pairs(hash, count_pair, &counts);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = i + 1; j < n; j++) {
+      bool overlaps =
+          bounding_box_overlaps(body_get_bounding_box(list_get(bodies, i)),
+                                body_get_bounding_box(list_get(bodies, j)));
+      assert(counts.counts[i * n + j] == (overlaps ? 1 : 0));
+    }
+  }
+  spatial_hash_free(hash);
+  free(counts.counts);
+}
+
+void test_empty_hash() {
+  list_t *bodies = list_init(0, (free_func_t)body_free);
+  check_pairs(bodies, 1);
+  list_free(bodies);
+}
+
+void test_separated_bodies() {
+  list_t *bodies = list_init(10, (free_func_t)body_free);
+  for (int i = 0; i < 10; i++) {
+    list_add(bodies, make_rectangle((vector_t){i * 3, -i * 3}, 1, 1));
+  }
+  check_pairs(bodies, 2);
+  list_free(bodies);
+}
+
+// Bodies much larger than a cell span many cells but are reported once
+void test_large_bodies() {
+  list_t *bodies = list_init(4, (free_func_t)body_free);
+  list_add(bodies, make_rectangle((vector_t){0, 0}, 40, 40));
+  list_add(bodies, make_rectangle((vector_t){10, 10}, 30, 30));
+  list_add(bodies, make_rectangle((vector_t){-15, 15}, 1, 1));
+  list_add(bodies, make_rectangle((vector_t){100, 100}, 1, 1));
+  check_pairs(bodies, 1);
+  list_free(bodies);
+}
+
+// Bodies spanning too many cells are kept out of the grid, but their pairs
+// with each other and with the bodies in the grid are still reported once
+void test_oversized_bodies() {
+  list_t *bodies = list_init(8, (free_func_t)body_free);
+  list_add(bodies, make_rectangle((vector_t){0, 0}, 2, 2));
+  list_add(bodies, make_rectangle((vector_t){0, 0}, 1e6, 1e6));
+  list_add(bodies, make_rectangle((vector_t){3, 0}, 2, 2));
+  list_add(bodies, make_rectangle((vector_t){0, 20}, 100, 1));
+  list_add(bodies, make_rectangle((vector_t){1e7, 0}, 1e6, 3));
+  list_add(bodies, make_rectangle((vector_t){0, 20}, 1, 1));
+  list_add(bodies, make_rectangle((vector_t){0, 0}, 1e100, 1e100));
+  // so far away that its cell coordinates don't fit in an integer
+  list_add(bodies, make_rectangle((vector_t){1e100, -1e100}, 1e90, 1e90));
+  check_pairs(bodies, 1);
+  check_pairs(bodies, 1e-3);
+  list_free(bodies);
+}
+
+void test_random_bodies() {
+  const size_t NUM_BODIES = 300;
+  srand(3);
+  list_t *bodies = list_init(NUM_BODIES, (free_func_t)body_free);
+  for (size_t i = 0; i < NUM_BODIES; i++) {
+    // include negative coordinates to test cells on both sides of 0
+    vector_t center = {rand() % 200 - 100, rand() % 200 - 100};
+    double w = 1 + rand() % 15, h = 1 + rand() % 15;
+    list_add(bodies, make_rectangle(center, w, h));
+  }
+  check_pairs(bodies, 5);
+  check_pairs(bodies, 0.7);
+  check_pairs(bodies, 1000);
+  list_free(bodies);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_empty_hash)
+  DO_TEST(test_separated_bodies)
+  DO_TEST(test_large_bodies)
+  DO_TEST(test_oversized_bodies)
+  DO_TEST(test_random_bodies)
+
+  puts("spatial_hash_test PASS");
+}
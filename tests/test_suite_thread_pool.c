@@ -0,0 +1,201 @@
+#include "test_util.h"
+#include "thread_pool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+// counts how many times each iteration of a loop ran
+void count_iterations(void *aux, size_t start, size_t end) {
+  size_t *counts = aux;
+  assert(start < end);
+  for (size_t i = start; i < end; i++) {
+    counts[i]++;
+  }
+}
+
+void test_thread_pool_for() {
+  const size_t COUNT = 1000;
+  size_t thread_counts[] = {0, 1, 2, 3, 8};
+  for (size_t t = 0; t < sizeof(thread_counts) / sizeof(*thread_counts);
+       t++) {
+    thread_pool_t *pool = thread_pool_init(thread_counts[t]);
+    assert(thread_pool_threads(pool) >= 1);
+    size_t *counts = calloc(COUNT, sizeof(size_t));
+    // the same workers are reused for many loops of different sizes
+    for (size_t loop = 0; loop < 100; loop++) {
+      thread_pool_for(pool, loop * 10 % (COUNT + 1), loop % 7, count_iterations,
+                      counts);
+    }
+    for (size_t i = 0; i < COUNT; i++) {
+      size_t expected = 0;
+      for (size_t loop = 0; loop < 100; loop++) {
+        expected += i < loop * 10 % (COUNT + 1);
+      }
+      assert(counts[i] == expected);
+    }
+    free(counts);
+    thread_pool_free(pool);
+  }
+}
+
+// sums a range of an array into a per-range slot, as a parallel reduction
+typedef struct {
+  double *values;
+  double *sums;
+} sum_aux_t;
+
+void sum_range(void *aux, size_t start, size_t end) {
+  sum_aux_t *sum = aux;
+  double total = 0;
+  for (size_t i = start; i < end; i++) {
+    total += sum->values[i];
+  }
+  // every range starts at a different index, so the slots don't collide
+  sum->sums[start] = total;
+}
+
+void test_thread_pool_sum() {
+  const size_t COUNT = 100000;
+  thread_pool_t *pool = thread_pool_init(4);
+  assert(thread_pool_threads(pool) == 4);
+  sum_aux_t sum = {.values = malloc(sizeof(double) * COUNT),
+                   .sums = calloc(COUNT, sizeof(double))};
+  for (size_t i = 0; i < COUNT; i++) {
+    sum.values[i] = 1;
+  }
+  thread_pool_for(pool, COUNT, 0, sum_range, &sum);
+  double total = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    total += sum.sums[i];
+  }
+  assert(total == COUNT);
+  free(sum.values);
+  free(sum.sums);
+  thread_pool_free(pool);
+}
+
+// checks that every range is at most the grain size
+void check_grain(void *aux, size_t start, size_t end) {
+  size_t *grain = aux;
+  assert(end - start <= *grain);
+}
+
+void test_thread_pool_stats() {
+  thread_pool_t *pool = thread_pool_init(3);
+  // more ranges than fit in a thread's queue
+  const size_t COUNT = 5000;
+  size_t grain = 1;
+  thread_pool_for(pool, COUNT, grain, check_grain, &grain);
+  grain = 7;
+  thread_pool_for(pool, COUNT, grain, check_grain, &grain);
+  size_t tasks_run = 0;
+  for (size_t i = 0; i < thread_pool_threads(pool); i++) {
+    thread_pool_stats_t stats = thread_pool_get_stats(pool, i);
+    assert(stats.tasks_stolen <= stats.tasks_run);
+    assert(stats.busy_seconds >= 0);
+    tasks_run += stats.tasks_run;
+  }
+  assert(tasks_run == COUNT + (COUNT + 6) / 7);
+  // ranges only start on thread 0, so the others ran stolen work
+  for (size_t i = 1; i < thread_pool_threads(pool); i++) {
+    thread_pool_stats_t stats = thread_pool_get_stats(pool, i);
+    assert(stats.tasks_stolen == stats.tasks_run);
+  }
+  thread_pool_reset_stats(pool);
+  for (size_t i = 0; i < thread_pool_threads(pool); i++) {
+    assert(thread_pool_get_stats(pool, i).tasks_run == 0);
+  }
+  thread_pool_free(pool);
+}
+
+// a job in a graph, which records when it ran
+typedef struct {
+  // the number of jobs that ran before this one, or -1 if it hasn't run
+  int position;
+  // shared by all the jobs in the graph
+  int *jobs_run;
+  pthread_mutex_t *lock;
+} graph_job_t;
+
+void run_graph_job(void *aux) {
+  graph_job_t *job = aux;
+  pthread_mutex_lock(job->lock);
+  assert(job->position == -1);
+  job->position = (*job->jobs_run)++;
+  pthread_mutex_unlock(job->lock);
+}
+
+void test_thread_pool_dependencies() {
+  // layers of jobs, where every job waits for all the jobs in the layer
+  // before it, plus a job on its own that waits for nothing
+  const size_t LAYERS = 5;
+  const size_t WIDTH = 6;
+  const size_t NUM_JOBS = LAYERS * WIDTH + 1;
+  size_t thread_counts[] = {1, 4};
+  for (size_t t = 0; t < sizeof(thread_counts) / sizeof(*thread_counts);
+       t++) {
+    thread_pool_t *pool = thread_pool_init(thread_counts[t]);
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+    int jobs_run = 0;
+    graph_job_t *jobs = malloc(sizeof(graph_job_t) * NUM_JOBS);
+    thread_job_t **added = malloc(sizeof(thread_job_t *) * NUM_JOBS);
+    for (size_t round = 0; round < 3; round++) {
+      jobs_run = 0;
+      // added in reverse, so jobs are added before their prerequisites
+      for (size_t i = NUM_JOBS; i > 0; i--) {
+        jobs[i - 1] =
+            (graph_job_t){.position = -1, .jobs_run = &jobs_run, .lock = &lock};
+        added[i - 1] = thread_pool_add_job(pool, run_graph_job, &jobs[i - 1]);
+      }
+      for (size_t layer = 1; layer < LAYERS; layer++) {
+        for (size_t i = 0; i < WIDTH; i++) {
+          for (size_t j = 0; j < WIDTH; j++) {
+            thread_pool_add_dependency(added[layer * WIDTH + i],
+                                       added[(layer - 1) * WIDTH + j]);
+          }
+        }
+      }
+      thread_pool_run(pool);
+      assert(jobs_run == (int)NUM_JOBS);
+      for (size_t layer = 0; layer < LAYERS; layer++) {
+        for (size_t i = 0; i < WIDTH; i++) {
+          // the layers ran in order, whichever threads ran them
+          int position = jobs[layer * WIDTH + i].position;
+          assert(position >= 0);
+          if (layer > 0) {
+            for (size_t j = 0; j < WIDTH; j++) {
+              assert(jobs[(layer - 1) * WIDTH + j].position < position);
+            }
+          }
+        }
+      }
+      assert(jobs[NUM_JOBS - 1].position >= 0);
+    }
+    // an empty run does nothing
+    thread_pool_run(pool);
+    // jobs that are never run are freed with the pool
+    thread_pool_add_job(pool, run_graph_job, &jobs[0]);
+    free(added);
+    free(jobs);
+    pthread_mutex_destroy(&lock);
+    thread_pool_free(pool);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_thread_pool_for)
+  DO_TEST(test_thread_pool_sum)
+  DO_TEST(test_thread_pool_stats)
+  DO_TEST(test_thread_pool_dependencies)
+
+  puts("thread_pool_test PASS");
+}
@@ -75,6 +75,20 @@ void test_vec_rotate() {
   assert(vec_isclose(vec_rotate(VEC_ZERO, 1.0), VEC_ZERO));
 }
 
+void test_vec_rotate_by() {
+  rotation_t quarter = rotation_from_angle(0.5 * M_PI);
+  assert(vec_isclose(vec_rotate_by((vector_t){5, 7}, quarter),
+                     (vector_t){-7, 5}));
+  assert(vec_equal(vec_rotate_by((vector_t){5, 7}, ROTATION_IDENTITY),
+                   (vector_t){5, 7}));
+  // the same rounding as computing the cosine and sine every time
+  for (double angle = -3; angle < 3; angle += 0.7) {
+    rotation_t rotation = rotation_from_angle(angle);
+    assert(vec_equal(vec_rotate_by((vector_t){1.5, -2.5}, rotation),
+                     vec_rotate((vector_t){1.5, -2.5}, angle)));
+  }
+}
+
 int main(int argc, char *argv[]) {
   // Run all tests if there are no command-line arguments
   bool all_tests = argc == 1;
@@ -92,6 +106,7 @@ int main(int argc, char *argv[]) {
   DO_TEST(test_vec_dot)
   DO_TEST(test_vec_cross)
   DO_TEST(test_vec_rotate)
+  DO_TEST(test_vec_rotate_by)
 
   puts("vector_test PASS");
 }